@@ -1,7 +1,8 @@
 #include <stdint.h>
 #include "atomic.h"
 
-#ifndef USE_GCC_BUILTIN_ATOMIC
+/* The out-of-line CAS is only used by the legacy engine, see atomic.h */
+#if defined(USE_LEGACY_ATOMIC) && !defined(USE_GCC_BUILTIN_ATOMIC)
 int32_t __cas_32( volatile void  * p, int32_t oldval, int32_t newval )
 {
   int32_t prev;
@@ -1,7 +1,43 @@
 #ifndef _ATOMIC_H_
 #define _ATOMIC_H_ 1
 
+#include <stdint.h>
+
+/* ****************************************************************************
+ * Two memory-ordering engines are provided:
+ *
+ *  - C11 (default): built on <stdatomic.h>. Shared links are _Atomic and every
+ *    access states its own ordering (relaxed/acquire/release); CAS is inlined.
+ *  - legacy (-DUSE_LEGACY_ATOMIC, `make ATOMIC=legacy`): the original engine.
+ *    Shared data is volatile, CAS is __cas_32/64 (or __sync_* builtins) and
+ *    ordered accesses are bracketed by mem_barrier() full fences.
+ *
+ * The library core only uses the accessors below, so both engines build the
+ * same algorithm and can be compared directly with lf_dlist_test.
+ *
+ *   ATOMIC_VAR            qualifier of a shared, atomically accessed field
+ *   ATOMIC_VOLATILE       qualifier of structures holding such fields
+ *   atomic_load_rlx/acq   relaxed / acquire load
+ *   atomic_store_rlx/rel  relaxed / release store
+ *   atomic_cas_ptr        pointer-sized CAS, acq_rel on success,
+ *                         returns true if [_old] was replaced by [_new] */
+
+/* spin-wait hint for busy loops (backoff, waiting on a flag) */
+#if defined(__x86_64__) || defined(__i386__)
+#define cpu_relax()  __builtin_ia32_pause()
+#elif defined(__aarch64__)
+#define cpu_relax()  __asm__ __volatile__ ( "yield" ::: "memory" )
+#else
+#define cpu_relax()  __asm__ __volatile__ ( "" ::: "memory" )
+#endif
+
 #ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_8
+#ifdef USE_LEGACY_ATOMIC
+
+#define ATOMIC_ENGINE_NAME  "legacy"
+#define ATOMIC_VAR          volatile
+#define ATOMIC_VOLATILE     volatile
+
 #ifdef USE_GCC_BUILTIN_ATOMIC
 #define atomic_cas_32 __sync_val_compare_and_swap
 #define atomic_cas_64 __sync_val_compare_and_swap
@@ -9,6 +45,7 @@
 #define atomic_dec_fetch(_ptr) __sync_sub_and_fetch(_ptr, 1)
 #define atomic_fetch_inc(_ptr) __sync_fetch_and_add(_ptr, 1)
 #define atomic_fetch_dec(_ptr) __sync_fetch_and_sub(_ptr, 1)
+#define atomic_add_fetch(_ptr, _v) __sync_add_and_fetch(_ptr, _v)
 #define mem_barrier()  __sync_synchronize()
 #else /* USE_GCC_BUILTIN_ATOMIC */
 int32_t __cas_32( volatile void * p, int32_t oldval, int32_t newval );
@@ -22,8 +59,47 @@ int64_t __cas_64( volatile void * p, int64_t oldval, int64_t newval );
 #define atomic_dec_fetch(_ptr) __sync_sub_and_fetch(_ptr, 1)
 #define atomic_fetch_inc(_ptr) __sync_fetch_and_add(_ptr, 1)
 #define atomic_fetch_dec(_ptr) __sync_fetch_and_sub(_ptr, 1)
+#define atomic_add_fetch(_ptr, _v) __sync_add_and_fetch(_ptr, _v)
 #define mem_barrier()  __sync_synchronize() // asm("nop")
 #endif /* USE_GCC_BUILTIN_ATOMIC */
+
+#define atomic_load_rlx( _p )          (*(_p))
+#define atomic_load_acq( _p )          __extension__ ({ mem_barrier(); *(_p); })
+#define atomic_store_rlx( _p, _v )     (*(_p) = (_v))
+#define atomic_store_rel( _p, _v )     do { mem_barrier(); *(_p) = (_v); } while( 0 )
+#define atomic_cas_ptr( _p, _old, _new )                              \
+  ((uint64_t)atomic_cas_64( (_p), (_old), (_new) ) == (uint64_t)(_old))
+
+#else /* USE_LEGACY_ATOMIC */
+#include <stdatomic.h>
+
+#define ATOMIC_ENGINE_NAME  "c11"
+#define ATOMIC_VAR          _Atomic
+#define ATOMIC_VOLATILE
+
+/* plain (non-_Atomic) integers, e.g. counters of the test program */
+#define atomic_cas_32 __sync_val_compare_and_swap
+#define atomic_cas_64 __sync_val_compare_and_swap
+#define atomic_inc_fetch(_ptr) __atomic_add_fetch(_ptr, 1, __ATOMIC_ACQ_REL)
+#define atomic_dec_fetch(_ptr) __atomic_sub_fetch(_ptr, 1, __ATOMIC_ACQ_REL)
+#define atomic_fetch_inc(_ptr) __atomic_fetch_add(_ptr, 1, __ATOMIC_ACQ_REL)
+#define atomic_fetch_dec(_ptr) __atomic_fetch_sub(_ptr, 1, __ATOMIC_ACQ_REL)
+#define atomic_add_fetch(_ptr, _v) __atomic_add_fetch(_ptr, _v, __ATOMIC_ACQ_REL)
+#define mem_barrier()  atomic_thread_fence( memory_order_seq_cst )
+
+#define atomic_load_rlx( _p )       atomic_load_explicit( (_p), memory_order_relaxed )
+#define atomic_load_acq( _p )       atomic_load_explicit( (_p), memory_order_acquire )
+#define atomic_store_rlx( _p, _v )  atomic_store_explicit( (_p), (_v), memory_order_relaxed )
+#define atomic_store_rel( _p, _v )  atomic_store_explicit( (_p), (_v), memory_order_release )
+#define atomic_cas_ptr( _p, _old, _new )                                \
+  __extension__ ({                                                      \
+    __typeof__( _old ) __expected = (_old);                             \
+    atomic_compare_exchange_strong_explicit( (_p), &__expected, (_new), \
+                                             memory_order_acq_rel,      \
+                                             memory_order_acquire );    \
+  })
+
+#endif /* USE_LEGACY_ATOMIC */
 #else /* __GCC_HAVE_SYNC_COMPARE_AND_SWAP_8 */
 
 #error Declare CAS functions are here
@@ -0,0 +1,203 @@
+#include <sched.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "atomic.h"
+#include "backoff.h"
+#include "util.h"
+
+/* Per-thread backoff state; never shared, so never bounced between cores.
+ * A thread keeps one per structure it backs off on, in a small direct-mapped
+ * table by the address of the structure: contention on one list does not
+ * widen the window of the next. A structure that takes the entry of another
+ * one starts from an empty window. */
+typedef struct _backoff_state backoff_state_t;
+struct _backoff_state
+{
+  const volatile void * owner;  /* structure of this entry, NULL if unused */
+  uint32_t seed;    /* xorshift32 state, 0 until first use */
+  uint32_t window;  /* current window of the exponential policies */
+  uint32_t fails;   /* consecutive failures (proportional policy) */
+};
+
+static __thread backoff_state_t g_backoff_state[BACKOFF_STATE_SLOTS];
+
+static const char * g_backoff_policy_name[BACKOFF_POLICY_MAX] =
+{
+  "random",
+  "exp",
+  "prop",
+  "spin"
+};
+
+static inline uint32_t backoff_rand( backoff_state_t * st )
+{
+  uint32_t x = st->seed;
+
+  if( x == 0 )
+    {
+      x = (uint32_t)rdtsc() ^ (uint32_t)(uintptr_t)st;
+      if( x == 0 )
+        {
+          x = 27644437; /* prime number */
+        }
+    }
+
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  st->seed = x;
+
+  return x;
+}
+
+static inline backoff_state_t * backoff_state_of( const volatile void * owner )
+{
+  backoff_state_t * st =
+    &(g_backoff_state[splitmix64( (uint64_t)(uintptr_t)owner ) & (BACKOFF_STATE_SLOTS - 1)]);
+
+  if( st->owner != owner )
+    {
+      /* the seed stays: it only has to differ between threads */
+      st->owner  = owner;
+      st->window = 0;
+      st->fails  = 0;
+    }
+
+  return st;
+}
+
+static inline void backoff_pause( uint32_t loops )
+{
+  while( loops-- )
+    {
+      cpu_relax();
+    }
+}
+
+static inline uint32_t backoff_grow_window( backoff_state_t * st, uint32_t max )
+{
+  if( st->window < BACKOFF_MIN_WINDOW )
+    {
+      st->window = BACKOFF_MIN_WINDOW;
+    }
+  else if( st->window < max )
+    {
+      st->window <<= 1;
+    }
+
+  if( st->window > max )
+    {
+      st->window = max;
+    }
+
+  return st->window;
+}
+
+void backoff_spin( const volatile void * owner, backoff_policy_t policy, uint32_t max )
+{
+  backoff_state_t * st = NULL;
+  uint32_t window = 0;
+
+  if( max == 0 )
+    {
+      return;
+    }
+
+  st = backoff_state_of( owner );
+
+  switch( policy )
+    {
+    case BACKOFF_EXPONENTIAL:
+      window = backoff_grow_window( st, max );
+      backoff_pause( backoff_rand( st ) % window );
+      break;
+
+    case BACKOFF_PROPORTIONAL:
+      /*  [max / 16] spins per consecutive failure, plus jitter */
+      if( st->fails < 16 )
+        {
+          st->fails++;
+        }
+      window = (max >> 4) * st->fails;
+      if( window == 0 || window > max )
+        {
+          window = max;
+        }
+      backoff_pause( (window >> 1) + backoff_rand( st ) % ((window >> 1) + 1) );
+      break;
+
+    case BACKOFF_SPIN_YIELD:
+      if( st->window >= max )
+        {
+          /*  spinning long enough already, let the others run */
+          sched_yield();
+          break;
+        }
+      window = backoff_grow_window( st, max );
+      backoff_pause( window );
+      break;
+
+    case BACKOFF_RANDOM:
+    default:
+      backoff_pause( backoff_rand( st ) % max );
+      break;
+    }
+}
+
+void backoff_reset( const volatile void * owner, backoff_policy_t policy )
+{
+  backoff_state_t * st = NULL;
+
+  if( policy == BACKOFF_RANDOM )
+    {
+      /* stateless but for the seed */
+      return;
+    }
+
+  st = backoff_state_of( owner );
+
+  switch( policy )
+    {
+    case BACKOFF_EXPONENTIAL:
+      st->window >>= 1;
+      break;
+
+    case BACKOFF_PROPORTIONAL:
+      st->fails >>= 1;
+      break;
+
+    case BACKOFF_SPIN_YIELD:
+      st->window = 0;
+      break;
+
+    case BACKOFF_RANDOM:
+    default:
+      break;
+    }
+}
+
+const char * backoff_policy_name( backoff_policy_t policy )
+{
+  if( (int32_t)policy < 0 || policy >= BACKOFF_POLICY_MAX )
+    {
+      return "unknown";
+    }
+
+  return g_backoff_policy_name[policy];
+}
+
+backoff_policy_t backoff_policy_parse( const char * name )
+{
+  int32_t i = 0;
+
+  for( i = 0 ; i < BACKOFF_POLICY_MAX ; i++ )
+    {
+      if( strcmp( name, g_backoff_policy_name[i] ) == 0 )
+        {
+          return (backoff_policy_t)i;
+        }
+    }
+
+  return BACKOFF_POLICY_MAX;
+}
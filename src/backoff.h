@@ -0,0 +1,45 @@
+#ifndef _BACKOFF_H_
+#define _BACKOFF_H_ 1
+
+#include <stdint.h>
+
+/* ****************************************************************************
+ * Backoff policies for CAS retry loops.
+ *
+ * All state a policy needs (RNG seed, current window, failure count) lives in
+ * thread-local storage, so choosing a spin count never writes shared memory.
+ * A thread has a state per [owner], the structure it retries on (a list):
+ * its window on one list does not carry over to another. Up to
+ * BACKOFF_STATE_SLOTS owners per thread keep theirs; beyond that, two
+ * owners may share an entry and restart each other's window.
+ * The spin loop itself issues cpu_relax() (pause) instead of full fences. */
+typedef enum _backoff_policy backoff_policy_t;
+enum _backoff_policy
+{
+  /* uniform random spin count in [0, max): the original behaviour */
+  BACKOFF_RANDOM       = 0,
+  /* randomized exponential: the window doubles per failure up to max and
+   * halves per success */
+  BACKOFF_EXPONENTIAL  = 1,
+  /* spin count proportional to the consecutive failures seen by the thread */
+  BACKOFF_PROPORTIONAL = 2,
+  /* exponential pause-spin; once the window reaches max, yield the CPU */
+  BACKOFF_SPIN_YIELD   = 3,
+  BACKOFF_POLICY_MAX
+};
+
+#define BACKOFF_MIN_WINDOW   16
+#define BACKOFF_STATE_SLOTS  8   /* owners per thread, a power of 2 */
+
+/* Called after a failed attempt on [owner]: waits according to [policy]
+ * and [max]. */
+void backoff_spin( const volatile void * owner, backoff_policy_t policy, uint32_t max );
+
+/* Called after a successful attempt on [owner]: shrinks the thread's
+ * window for it. */
+void backoff_reset( const volatile void * owner, backoff_policy_t policy );
+
+const char * backoff_policy_name( backoff_policy_t policy );
+backoff_policy_t backoff_policy_parse( const char * name );
+
+#endif /* _BACKOFF_H_ */
@@ -0,0 +1,61 @@
+#include <string.h>
+#include <stdint.h>
+
+#include "atomic.h"
+#include "counter.h"
+#include "util.h"
+
+void counter_init( counter_t * c )
+{
+  memset( (void *)c, 0x00, sizeof(counter_t) );
+}
+
+void counter_add( counter_t * c, int64_t delta )
+{
+  int32_t slot = thread_slot_id();
+
+  if( slot < 0 )
+    {
+      slot = 0;
+    }
+
+  /* a shard may be shared once there are more than COUNTER_SHARD_MAX */
+  /* threads, hence the atomic add; it stays in the local cache otherwise */
+  (void)atomic_add_fetch( &(c->shards[slot % COUNTER_SHARD_MAX].val), delta );
+}
+
+int64_t counter_read( counter_t * c )
+{
+  int64_t sum = 0;
+  int32_t hw  = thread_slot_high_water();
+  int32_t i   = 0;
+
+  if( hw > COUNTER_SHARD_MAX )
+    {
+      hw = COUNTER_SHARD_MAX;
+    }
+
+  for( i = 0 ; i < hw ; i++ )
+    {
+      sum += ((volatile counter_shard_t *)&(c->shards[i]))->val;
+    }
+
+  return sum;
+}
+
+int64_t counter_read_approx( counter_t * c )
+{
+  uint64_t now = rdtsc();
+  int64_t  sum = 0;
+
+  if( now - atomic_load_rlx( &(c->approx_tsc) ) < COUNTER_APPROX_CYCLES )
+    {
+      return atomic_load_rlx( &(c->approx) );
+    }
+
+  sum = counter_read( c );
+  atomic_store_rlx( &(c->approx), sum );
+  atomic_store_rlx( &(c->approx_tsc), now );
+
+  return sum;
+}
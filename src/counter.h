@@ -0,0 +1,45 @@
+#ifndef _COUNTER_H_
+#define _COUNTER_H_ 1
+
+#include <stdint.h>
+#include "atomic.h"
+#include "util.h"
+
+/* ****************************************************************************
+ * Sharded counter.
+ *
+ * counter_add() only touches the shard of the calling thread slot (util.h),
+ * one cache line per shard, so concurrent updates never bounce a shared
+ * line. counter_read() sums the shards in use and is exact once the updates
+ * in flight are done. counter_read_approx() returns a cached sum that is
+ * refreshed at most every COUNTER_APPROX_CYCLES cycles, so polling it does
+ * not pull the shards away from their writers either.
+ *
+ * A zero-filled counter_t is a valid counter of value 0. */
+
+#define COUNTER_SHARD_MAX      64          /* slots beyond share shards */
+#define COUNTER_APPROX_CYCLES  (1 << 20)   /* ~0.3ms at 3GHz */
+
+typedef struct _counter_shard counter_shard_t;
+struct _counter_shard
+{
+  int64_t   val;
+  char      pad[64 - sizeof(int64_t)];
+} __attribute__((aligned(64)));
+
+typedef struct _counter counter_t;
+struct _counter
+{
+  /* refreshed by the readers of counter_read_approx() */
+  int64_t ATOMIC_VAR   approx;
+  uint64_t ATOMIC_VAR  approx_tsc;
+  char                 pad[64 - 2 * sizeof(int64_t)];
+  counter_shard_t      shards[COUNTER_SHARD_MAX];
+} __attribute__((aligned(64)));
+
+void counter_init( counter_t * c );
+void counter_add( counter_t * c, int64_t delta );
+int64_t counter_read( counter_t * c );
+int64_t counter_read_approx( counter_t * c );
+
+#endif /* _COUNTER_H_ */
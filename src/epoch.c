@@ -0,0 +1,536 @@
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "atomic.h"
+#include "epoch.h"
+#include "util.h"
+
+#define EPOCH_ACTIVE        ((uint64_t)1)
+#define EPOCH_BAG_CNT       3   /* epochs e-2, e-1 and e may hold nodes */
+#define EPOCH_BAG_INIT_CAP  EPOCH_RECLAIM_BATCH
+
+/* Announced epoch of a thread slot, one cache line per slot */
+typedef struct _epoch_slot epoch_slot_t;
+struct _epoch_slot
+{
+  /* (epoch << 1) | EPOCH_ACTIVE inside a critical section, 0 otherwise */
+  uint64_t ATOMIC_VAR state;
+  char                pad[64 - sizeof(uint64_t)];
+} __attribute__((aligned(64)));
+
+/* Hazard pointers of a thread slot, one cache line per slot */
+typedef struct _epoch_hazard epoch_hazard_t;
+struct _epoch_hazard
+{
+  void * ATOMIC_VAR hp[EPOCH_HAZARD_MAX];
+} __attribute__((aligned(64)));
+
+typedef struct _epoch_retired epoch_retired_t;
+struct _epoch_retired
+{
+  void            * ptr;
+  epoch_free_fn_t   free_fn;
+};
+
+typedef struct _epoch_bag epoch_bag_t;
+struct _epoch_bag
+{
+  uint64_t          epoch;  /* global epoch the items were retired in */
+  uint32_t          cnt;
+  uint32_t          cap;
+  epoch_retired_t * items;
+  epoch_bag_t     * next;   /* link of the orphan list */
+};
+
+/* Thread-local part; never read by other threads */
+typedef struct _epoch_local epoch_local_t;
+struct _epoch_local
+{
+  uint32_t     nest;        /* depth of nested critical sections */
+  uint32_t     retire_cnt;  /* retirements since the last reclamation */
+  uint32_t     hazard_used; /* bitmap of the allocated hazard slots */
+  epoch_bag_t  bags[EPOCH_BAG_CNT];
+};
+
+static uint64_t ATOMIC_VAR  g_epoch = 1;
+static epoch_slot_t         g_epoch_slots[THREAD_SLOT_MAX];
+static epoch_hazard_t       g_epoch_hazards[THREAD_SLOT_MAX];
+/* allocated hazard slots of all threads; no scan is needed while 0 */
+static volatile int32_t     g_epoch_hazard_cnt = 0;
+static __thread epoch_local_t t_epoch = { 0, 0, 0, {{ 0, 0, 0, NULL, NULL }} };
+
+/* bags left behind by exited threads */
+static pthread_mutex_t      g_epoch_orphan_mtx = PTHREAD_MUTEX_INITIALIZER;
+static epoch_bag_t        * g_epoch_orphans = NULL;
+static volatile int32_t     g_epoch_orphan_cnt = 0;
+
+static pthread_once_t       g_epoch_once = PTHREAD_ONCE_INIT;
+
+static void epoch_thread_exit( int32_t slot );
+
+static void epoch_init( void )
+{
+  (void)thread_slot_atexit( epoch_thread_exit );
+}
+
+static inline epoch_slot_t * epoch_my_slot( void )
+{
+  int32_t slot = thread_slot_id();
+
+  if( slot < 0 )
+    {
+      fprintf( stderr, "epoch: more than %d threads in use\n", THREAD_SLOT_MAX );
+      abort();
+    }
+
+  return &g_epoch_slots[slot];
+}
+
+void epoch_enter( void )
+{
+  epoch_slot_t * slot = NULL;
+  uint64_t       e = 0;
+
+  if( t_epoch.nest++ > 0 )
+    {
+      return;
+    }
+
+  (void)pthread_once( &g_epoch_once, epoch_init );
+  slot = epoch_my_slot();
+  e = atomic_load_acq( &g_epoch );
+  while( true )
+    {
+      atomic_store_rlx( &(slot->state), (e << 1) | EPOCH_ACTIVE );
+      /* the announcement must be visible before any node is read */
+      mem_barrier();
+
+      /* if the epoch moved meanwhile, the advancer may have missed us */
+      if( atomic_load_acq( &g_epoch ) == e )
+        {
+          break;
+        }
+      e = atomic_load_acq( &g_epoch );
+    }
+}
+
+void epoch_exit( void )
+{
+  if( --t_epoch.nest > 0 )
+    {
+      return;
+    }
+
+  atomic_store_rel( &(epoch_my_slot()->state), 0 );
+}
+
+bool epoch_in_critical( void )
+{
+  return (t_epoch.nest > 0) ? true : false;
+}
+
+uint64_t epoch_current( void )
+{
+  return atomic_load_acq( &g_epoch );
+}
+
+/* Collect the published hazard pointers of all threads into [snap] */
+static uint32_t epoch_hazard_snapshot( void ** snap )
+{
+  void    * ptr = NULL;
+  uint32_t  cnt = 0;
+  int32_t   hw  = 0;
+  int32_t   i   = 0;
+  int32_t   j   = 0;
+
+  /* the caller saw the grace period end: the hazards published */
+  /* before that are visible from here on */
+  mem_barrier();
+  hw = thread_slot_high_water();
+
+  for( i = 0 ; i < hw ; i++ )
+    {
+      for( j = 0 ; j < EPOCH_HAZARD_MAX ; j++ )
+        {
+          ptr = atomic_load_acq( &(g_epoch_hazards[i].hp[j]) );
+          if( ptr != NULL )
+            {
+              snap[cnt++] = ptr;
+            }
+        }
+    }
+
+  return cnt;
+}
+
+/* Free the items of [bag]; those still named by a hazard pointer are kept */
+static void epoch_bag_free( epoch_bag_t * bag )
+{
+  void     * snap[THREAD_SLOT_MAX * EPOCH_HAZARD_MAX];
+  uint32_t   snap_cnt = 0;
+  uint32_t   kept = 0;
+  uint32_t   i = 0;
+  uint32_t   j = 0;
+
+  if( bag->cnt == 0 )
+    {
+      return;
+    }
+
+  if( g_epoch_hazard_cnt > 0 )
+    {
+      snap_cnt = epoch_hazard_snapshot( snap );
+    }
+
+  for( i = 0 ; i < bag->cnt ; i++ )
+    {
+      for( j = 0 ; j < snap_cnt ; j++ )
+        {
+          if( snap[j] == bag->items[i].ptr )
+            {
+              break;
+            }
+        }
+
+      if( j < snap_cnt )
+        {
+          bag->items[kept++] = bag->items[i];
+        }
+      else
+        {
+          bag->items[i].free_fn( bag->items[i].ptr );
+        }
+    }
+
+  bag->cnt = kept;
+}
+
+/* Advance the global epoch if every active thread has observed it */
+static bool epoch_try_advance( void )
+{
+  uint64_t e     = 0;
+  uint64_t state = 0;
+  int32_t  hw    = 0;
+  int32_t  i     = 0;
+
+  mem_barrier();
+  e  = atomic_load_acq( &g_epoch );
+  hw = thread_slot_high_water();
+
+  for( i = 0 ; i < hw ; i++ )
+    {
+      state = atomic_load_acq( &(g_epoch_slots[i].state) );
+      if( (state & EPOCH_ACTIVE) && (state >> 1) != e )
+        {
+          return false;
+        }
+    }
+
+  return atomic_cas_ptr( &g_epoch, e, e + 1 );
+}
+
+static void epoch_reclaim_orphans( uint64_t e, bool wait )
+{
+  epoch_bag_t ** prev = NULL;
+  epoch_bag_t  * bag  = NULL;
+
+  if( wait == true )
+    {
+      pthread_mutex_lock( &g_epoch_orphan_mtx );
+    }
+  else if( pthread_mutex_trylock( &g_epoch_orphan_mtx ) != 0 )
+    {
+      /* someone else is on it */
+      return;
+    }
+
+  for( prev = &g_epoch_orphans ; *prev != NULL ; )
+    {
+      bag = *prev;
+      if( bag->epoch + 2 <= e )
+        {
+          epoch_bag_free( bag );
+        }
+
+      if( bag->cnt == 0 )
+        {
+          *prev = bag->next;
+          free( bag->items );
+          free( bag );
+          atomic_dec_fetch( &g_epoch_orphan_cnt );
+        }
+      else
+        {
+          prev = &(bag->next);
+        }
+    }
+
+  pthread_mutex_unlock( &g_epoch_orphan_mtx );
+}
+
+/* thread_slot_atexit() hook: the thread is gone, so it can neither be */
+/* inside a critical section nor free its bags later: hand them over */
+static void epoch_thread_exit( int32_t slot )
+{
+  epoch_local_t * local  = &t_epoch;
+  epoch_bag_t   * orphan = NULL;
+  int32_t         i = 0;
+
+  local->nest = 0;
+  atomic_store_rel( &(g_epoch_slots[slot].state), 0 );
+
+  for( i = 0 ; i < EPOCH_HAZARD_MAX ; i++ )
+    {
+      if( local->hazard_used & (1U << i) )
+        {
+          atomic_store_rel( &(g_epoch_hazards[slot].hp[i]), NULL );
+          atomic_dec_fetch( &g_epoch_hazard_cnt );
+        }
+    }
+  local->hazard_used = 0;
+
+  for( i = 0 ; i < EPOCH_BAG_CNT ; i++ )
+    {
+      if( local->bags[i].cnt == 0 )
+        {
+          free( local->bags[i].items );
+        }
+      else
+        {
+          orphan = (epoch_bag_t *)malloc( sizeof(epoch_bag_t) );
+          if( orphan == NULL )
+            {
+              /* cannot wait for a grace period here: leak rather than */
+              /* free nodes that may still be read */
+              fprintf( stderr, "epoch: %u retired nodes leaked\n", local->bags[i].cnt );
+              continue;
+            }
+
+          *orphan = local->bags[i];
+          pthread_mutex_lock( &g_epoch_orphan_mtx );
+          orphan->next = g_epoch_orphans;
+          g_epoch_orphans = orphan;
+          atomic_inc_fetch( &g_epoch_orphan_cnt );
+          pthread_mutex_unlock( &g_epoch_orphan_mtx );
+        }
+
+      memset( &(local->bags[i]), 0x00, sizeof(epoch_bag_t) );
+    }
+}
+
+int32_t epoch_retire( void * ptr, epoch_free_fn_t free_fn )
+{
+  epoch_local_t   * local = &t_epoch;
+  epoch_bag_t     * bag   = NULL;
+  epoch_retired_t * items = NULL;
+  uint64_t          e     = 0;
+  uint32_t          cap   = 0;
+
+  /* owning a slot makes sure the bags are handed over at thread exit */
+  (void)pthread_once( &g_epoch_once, epoch_init );
+  (void)epoch_my_slot();
+
+  /* order the unlink of [ptr] before reading the epoch */
+  mem_barrier();
+  e   = atomic_load_acq( &g_epoch );
+  bag = &(local->bags[e % EPOCH_BAG_CNT]);
+
+  if( bag->epoch != e )
+    {
+      /* the bag was filled 3 or more epochs ago: all of it is safe now, */
+      /* but for the hazard-protected nodes which move to epoch [e] */
+      epoch_bag_free( bag );
+      bag->epoch = e;
+    }
+
+  if( bag->cnt == bag->cap )
+    {
+      cap   = (bag->cap == 0) ? EPOCH_BAG_INIT_CAP : bag->cap * 2;
+      items = (epoch_retired_t *)realloc( bag->items, cap * sizeof(epoch_retired_t) );
+      TRY( items == NULL );
+
+      bag->items = items;
+      bag->cap   = cap;
+    }
+
+  bag->items[bag->cnt].ptr     = ptr;
+  bag->items[bag->cnt].free_fn = free_fn;
+  bag->cnt++;
+
+  if( ++local->retire_cnt >= EPOCH_RECLAIM_BATCH )
+    {
+      local->retire_cnt = 0;
+      epoch_reclaim();
+    }
+
+  return RC_SUCCESS;
+
+  CATCH_END;
+
+  return RC_FAIL;
+}
+
+int32_t epoch_retire_reserve( uint32_t cnt )
+{
+  epoch_local_t   * local = &t_epoch;
+  epoch_bag_t     * bag   = NULL;
+  epoch_retired_t * items = NULL;
+  uint32_t          cap   = 0;
+  int32_t           i     = 0;
+
+  /* any bag may take the next retirements, and a bag only empties when */
+  /* its items are freed, which leaves its capacity as it is */
+  for( i = 0 ; i < EPOCH_BAG_CNT ; i++ )
+    {
+      bag = &(local->bags[i]);
+      if( bag->cnt + cnt <= bag->cap )
+        {
+          continue;
+        }
+
+      cap = (bag->cap == 0) ? EPOCH_BAG_INIT_CAP : bag->cap;
+      while( cap < bag->cnt + cnt )
+        {
+          cap *= 2;
+        }
+      items = (epoch_retired_t *)realloc( bag->items, cap * sizeof(epoch_retired_t) );
+      TRY( items == NULL );
+
+      bag->items = items;
+      bag->cap   = cap;
+    }
+
+  return RC_SUCCESS;
+
+  CATCH_END;
+
+  return RC_FAIL;
+}
+
+void epoch_reclaim( void )
+{
+  epoch_local_t * local = &t_epoch;
+  uint64_t        e = 0;
+  int32_t         i = 0;
+
+  (void)epoch_try_advance();
+  e = atomic_load_acq( &g_epoch );
+
+  for( i = 0 ; i < EPOCH_BAG_CNT ; i++ )
+    {
+      if( local->bags[i].cnt > 0 && local->bags[i].epoch + 2 <= e )
+        {
+          epoch_bag_free( &(local->bags[i]) );
+        }
+    }
+
+  if( g_epoch_orphan_cnt > 0 )
+    {
+      epoch_reclaim_orphans( e, false );
+    }
+}
+
+void epoch_barrier( void )
+{
+  uint64_t target = 0;
+
+  if( epoch_in_critical() == true )
+    {
+      /* would wait for ourselves */
+      return;
+    }
+
+  target = atomic_load_acq( &g_epoch ) + 2;
+  while( atomic_load_acq( &g_epoch ) < target )
+    {
+      if( epoch_try_advance() == false )
+        {
+          sched_yield();
+        }
+    }
+
+  /* every bag of ours is at least two epochs old now */
+  epoch_reclaim();
+  epoch_reclaim_orphans( atomic_load_acq( &g_epoch ), true );
+}
+
+int32_t epoch_hazard_alloc( void )
+{
+  epoch_local_t * local = &t_epoch;
+  int32_t         i = 0;
+
+  (void)pthread_once( &g_epoch_once, epoch_init );
+  (void)epoch_my_slot();
+
+  for( i = 0 ; i < EPOCH_HAZARD_MAX ; i++ )
+    {
+      if( (local->hazard_used & (1U << i)) == 0 )
+        {
+          local->hazard_used |= (1U << i);
+          atomic_inc_fetch( &g_epoch_hazard_cnt );
+          return i;
+        }
+    }
+
+  return -1;
+}
+
+void epoch_hazard_release( int32_t idx )
+{
+  epoch_local_t * local = &t_epoch;
+
+  if( idx < 0 || idx >= EPOCH_HAZARD_MAX ||
+      (local->hazard_used & (1U << idx)) == 0 )
+    {
+      return;
+    }
+
+  atomic_store_rel( &(g_epoch_hazards[thread_slot_id()].hp[idx]), NULL );
+  local->hazard_used &= ~(1U << idx);
+  atomic_dec_fetch( &g_epoch_hazard_cnt );
+}
+
+void epoch_hazard_set( int32_t idx, void * ptr )
+{
+  atomic_store_rel( &(g_epoch_hazards[thread_slot_id()].hp[idx]), ptr );
+}
+
+bool epoch_hazard_held( const void * ptr )
+{
+  int32_t  self = thread_slot_id();
+  int32_t  hw   = 0;
+  int32_t  i    = 0;
+  int32_t  j    = 0;
+
+  if( ptr == NULL || g_epoch_hazard_cnt == 0 )
+    {
+      return false;
+    }
+
+  /* pairs with the barrier a reader issues between publishing and */
+  /* validating: one of the two sees the other's write */
+  mem_barrier();
+  hw = thread_slot_high_water();
+
+  for( i = 0 ; i < hw ; i++ )
+    {
+      if( i == self )
+        {
+          continue;
+        }
+
+      for( j = 0 ; j < EPOCH_HAZARD_MAX ; j++ )
+        {
+          if( atomic_load_acq( &(g_epoch_hazards[i].hp[j]) ) == ptr )
+            {
+              return true;
+            }
+        }
+    }
+
+  return false;
+}
@@ -0,0 +1,76 @@
+#ifndef _EPOCH_H_
+#define _EPOCH_H_ 1
+
+#include <stdint.h>
+#include "util.h"
+
+/* ****************************************************************************
+ * Epoch-based memory reclamation.
+ *
+ * A thread reads shared nodes only inside a critical section
+ * (epoch_enter() ... epoch_exit(); sections nest). An unlinked node is handed
+ * to epoch_retire() instead of being freed: it is put in a per-thread bag
+ * tagged with the global epoch and freed in a batch once the global epoch
+ * has advanced twice, i.e. once every thread that was inside a critical
+ * section when the node was unlinked has left it.
+ *
+ * The global epoch advances only when every thread inside a critical section
+ * has observed the current one, so a thread staying in a critical section
+ * for long delays (but never breaks) reclamation. Per-thread records live in
+ * the slots of thread_slot_id() (util.h). */
+
+typedef void (*epoch_free_fn_t)( void * ptr );
+
+/* retirements between two reclamation attempts of a thread */
+#define EPOCH_RECLAIM_BATCH  64
+
+/* hazard pointers a thread can hold at once */
+#define EPOCH_HAZARD_MAX     8
+
+void epoch_enter( void );
+void epoch_exit( void );
+bool epoch_in_critical( void );
+
+/* Free [ptr] with [free_fn] after a grace period. [ptr] must already be
+ * unreachable for threads entering a critical section from now on. */
+int32_t epoch_retire( void * ptr, epoch_free_fn_t free_fn );
+
+/* Make room for [cnt] more retirements of the calling thread: its next
+ * [cnt] epoch_retire() calls cannot fail. Lets a caller that must retire
+ * after an unlink find out it is out of memory before the unlink. */
+int32_t epoch_retire_reserve( uint32_t cnt );
+
+/* Try to advance the global epoch and free the bags that became safe */
+void epoch_reclaim( void );
+
+/* Wait for a grace period and free everything retired by the calling thread
+ * and by threads that have exited. Must be called outside of a critical
+ * section; e.g. at shutdown after the worker threads are joined. */
+void epoch_barrier( void );
+
+uint64_t epoch_current( void );
+
+/* Hazard pointers keep a few nodes alive outside of a critical section,
+ * e.g. the position of a cursor between two moves: a retired node whose
+ * address is published in a hazard slot is not freed until the slot is
+ * cleared, whatever the epoch is. A pointer must be published from inside
+ * a critical section in which the node was reachable. Per thread at most
+ * EPOCH_HAZARD_MAX slots exist, so at most that many retired nodes per
+ * thread outlive their grace period.
+ *
+ * epoch_hazard_alloc() returns a slot index of the calling thread, or -1 if
+ * all of them are in use. */
+int32_t epoch_hazard_alloc( void );
+void epoch_hazard_release( int32_t idx );
+void epoch_hazard_set( int32_t idx, void * ptr );
+
+/* Reader indicator: true if a thread other than the caller has [ptr] in one
+ * of its hazard slots. Readers announce themselves with no shared write, in
+ * their own slots; a writer pays for a scan of all slots instead. For a
+ * reliable answer, a reader publishes, issues mem_barrier() and then checks
+ * that the node is still valid for it, while the writer invalidates it
+ * (e.g. with a state CAS) before asking: then either the reader sees the
+ * change and backs off, or the writer sees the reader. */
+bool epoch_hazard_held( const void * ptr );
+
+#endif /* _EPOCH_H_ */
@@ -0,0 +1,426 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "atomic.h"
+#include "counter.h"
+#include "epoch.h"
+#include "evict.h"
+#include "util.h"
+
+#define evict_meta_of( _ev, _node ) \
+  ((evict_meta_t *)((char *)(_node) + (_ev)->meta_offset))
+
+static bool evict_meta_cas( evict_meta_t * meta, uint64_t old, uint64_t new )
+{
+  return atomic_cas_ptr( &(meta->word), old, new );
+}
+
+/* ****************************************************************************
+ * clock: bit 0 is the reference bit
+ */
+#define EVICT_CLOCK_REF  ((uint64_t)0x1)
+
+static void evict_clock_access( evictor_t * ev, evict_meta_t * meta )
+{
+  uint64_t w = atomic_load_rlx( &(meta->word) );
+
+  (void)ev;
+
+  /* read before write: a hot node does not bounce its line */
+  while( (w & EVICT_CLOCK_REF) == 0 &&
+         evict_meta_cas( meta, w, w | EVICT_CLOCK_REF ) == false )
+    {
+      w = atomic_load_rlx( &(meta->word) );
+    }
+}
+
+static bool evict_clock_visit( evictor_t * ev, evict_meta_t * meta )
+{
+  uint64_t w = atomic_load_rlx( &(meta->word) );
+
+  (void)ev;
+
+  if( w & EVICT_CLOCK_REF )
+    {
+      /* second chance; an access racing with us keeps its bit */
+      (void)evict_meta_cas( meta, w, w & ~EVICT_CLOCK_REF );
+      return false;
+    }
+
+  return true;
+}
+
+/* ****************************************************************************
+ * lfu: frequency in bits 0..15, the decay epoch it is valid for in 16..63.
+ * A frequency stamped n epochs ago is worth freq >> n, 0 from n = 16 on:
+ * the age saturates there, and a 48-bit stamp does not wrap back to a
+ * small age in any run.
+ */
+#define EVICT_LFU_FREQ_MAX    ((uint64_t)0xFFFF)
+#define EVICT_LFU_STAMP_MASK  ((uint64_t)0xFFFFFFFFFFFF)
+#define EVICT_LFU_STAMP(_w)   ((_w) >> 16)
+#define EVICT_LFU_AGE_MAX     16
+
+static uint64_t evict_lfu_freq( evictor_t * ev, uint64_t w )
+{
+  uint64_t age = (atomic_load_rlx( &(ev->decay) ) - EVICT_LFU_STAMP( w )) & EVICT_LFU_STAMP_MASK;
+
+  return ( age >= EVICT_LFU_AGE_MAX ) ? 0 : ((w & EVICT_LFU_FREQ_MAX) >> age);
+}
+
+static uint64_t evict_lfu_word( evictor_t * ev, uint64_t freq )
+{
+  return ((atomic_load_rlx( &(ev->decay) ) & EVICT_LFU_STAMP_MASK) << 16) | freq;
+}
+
+static void evict_lfu_insert( evictor_t * ev, evict_meta_t * meta )
+{
+  atomic_store_rlx( &(meta->word), evict_lfu_word( ev, 0 ) );
+}
+
+static void evict_lfu_access( evictor_t * ev, evict_meta_t * meta )
+{
+  uint64_t w    = 0;
+  uint64_t freq = 0;
+
+  do
+    {
+      w    = atomic_load_rlx( &(meta->word) );
+      freq = evict_lfu_freq( ev, w );
+      if( freq < EVICT_LFU_FREQ_MAX )
+        {
+          freq++;
+        }
+    } while( evict_meta_cas( meta, w, evict_lfu_word( ev, freq ) ) == false );
+}
+
+static bool evict_lfu_visit( evictor_t * ev, evict_meta_t * meta )
+{
+  uint64_t w    = atomic_load_rlx( &(meta->word) );
+  uint64_t freq = evict_lfu_freq( ev, w );
+
+  if( freq == 0 )
+    {
+      return true;
+    }
+
+  /* every pass of the hand costs one access */
+  (void)evict_meta_cas( meta, w, evict_lfu_word( ev, freq - 1 ) );
+  return false;
+}
+
+static void evict_lfu_revolution( evictor_t * ev )
+{
+  /* halves every frequency, lazily */
+  atomic_store_rlx( &(ev->decay), atomic_load_rlx( &(ev->decay) ) + 1 );
+}
+
+/* ****************************************************************************
+ * 2q: bit 1 tells Am from A1, bit 0 is the reference bit (in A1: seen once),
+ * bit 2 that the node left the list and was taken off the counts
+ */
+#define EVICT_2Q_REF   ((uint64_t)0x1)
+#define EVICT_2Q_AM    ((uint64_t)0x2)
+#define EVICT_2Q_GONE  ((uint64_t)0x4)
+
+static void evict_2q_insert( evictor_t * ev, evict_meta_t * meta )
+{
+  (void)meta;
+
+  counter_add( &(ev->a1), 1 );
+}
+
+static void evict_2q_access( evictor_t * ev, evict_meta_t * meta )
+{
+  uint64_t w = 0;
+
+  while( true )
+    {
+      w = atomic_load_rlx( &(meta->word) );
+      if( w & EVICT_2Q_GONE )
+        {
+          /* a late access: promoting it would count it again */
+          return;
+        }
+
+      if( (w & EVICT_2Q_REF) == 0 )
+        {
+          if( evict_meta_cas( meta, w, w | EVICT_2Q_REF ) )
+            {
+              return;
+            }
+          continue;
+        }
+
+      if( w & EVICT_2Q_AM )
+        {
+          return;
+        }
+
+      /* second access in A1: promote */
+      if( evict_meta_cas( meta, w, w | EVICT_2Q_AM ) )
+        {
+          counter_add( &(ev->a1), -1 );
+          counter_add( &(ev->am), 1 );
+          return;
+        }
+    }
+}
+
+static bool evict_2q_visit( evictor_t * ev, evict_meta_t * meta )
+{
+  uint64_t w  = atomic_load_rlx( &(meta->word) );
+  int64_t  a1 = counter_read_approx( &(ev->a1) );
+  int64_t  am = counter_read_approx( &(ev->am) );
+
+  if( (w & EVICT_2Q_AM) == 0 )
+    {
+      /* A1 is a FIFO: its nodes go in list order. Below its share it is */
+      /* left alone, unless the last revolution found no victim in Am. */
+      return ( a1 * EVICT_2Q_A1_SHARE > a1 + am || ev->starved == true ) ? true : false;
+    }
+
+  if( w & EVICT_2Q_REF )
+    {
+      (void)evict_meta_cas( meta, w, w & ~EVICT_2Q_REF );
+      return false;
+    }
+
+  return true;
+}
+
+static void evict_2q_evict( evictor_t * ev, evict_meta_t * meta )
+{
+  uint64_t w = 0;
+
+  /* once per node: a victim may also be forgotten by its deleter, and */
+  /* the CAS orders us with a promotion in evict_2q_access() */
+  do
+    {
+      w = atomic_load_rlx( &(meta->word) );
+      if( w & EVICT_2Q_GONE )
+        {
+          return;
+        }
+    } while( evict_meta_cas( meta, w, w | EVICT_2Q_GONE ) == false );
+
+  if( w & EVICT_2Q_AM )
+    {
+      counter_add( &(ev->am), -1 );
+    }
+  else
+    {
+      counter_add( &(ev->a1), -1 );
+    }
+}
+
+static const evict_ops_t g_evict_ops[EVICT_POLICY_MAX] =
+{
+  { "clock",
+    NULL, evict_clock_access, evict_clock_visit, NULL, NULL },
+  { "lfu",
+    evict_lfu_insert, evict_lfu_access, evict_lfu_visit,
+    NULL, evict_lfu_revolution },
+  { "2q",
+    evict_2q_insert, evict_2q_access, evict_2q_visit, evict_2q_evict, NULL }
+};
+
+const evict_ops_t * evict_policy_ops( evict_policy_t policy )
+{
+  if( (int32_t)policy < 0 || policy >= EVICT_POLICY_MAX )
+    {
+      return NULL;
+    }
+
+  return &g_evict_ops[policy];
+}
+
+const char * evict_policy_name( evict_policy_t policy )
+{
+  if( (int32_t)policy < 0 || policy >= EVICT_POLICY_MAX )
+    {
+      return "unknown";
+    }
+
+  return g_evict_ops[policy].name;
+}
+
+evict_policy_t evict_policy_parse( const char * name )
+{
+  int32_t i = 0;
+
+  for( i = 0 ; i < EVICT_POLICY_MAX ; i++ )
+    {
+      if( strcmp( name, g_evict_ops[i].name ) == 0 )
+        {
+          return (evict_policy_t)i;
+        }
+    }
+
+  return EVICT_POLICY_MAX;
+}
+
+/* ****************************************************************************
+ * evictor_t
+ */
+
+int32_t evictor_create( evictor_t        ** _ev,
+                        lf_dlist_t        * l,
+                        const evict_ops_t * ops,
+                        size_t              meta_offset,
+                        evict_admit_fn_t    admit,
+                        void              * admit_ctx )
+{
+  evictor_t * ev = NULL;
+
+  TRY( _ev == NULL || l == NULL || ops == NULL );
+
+  /* the counters are cache line aligned */
+  TRY( posix_memalign( (void **)&ev, 64, sizeof(evictor_t) ) != 0 );
+  memset( (void *)ev, 0x00, sizeof(evictor_t) );
+
+  ev->l           = l;
+  ev->ops         = ops;
+  ev->meta_offset = meta_offset;
+  ev->admit       = admit;
+  ev->admit_ctx   = admit_ctx;
+  ev->anchor_hazard = -1;
+  counter_init( &(ev->a1) );
+  counter_init( &(ev->am) );
+
+  *_ev = ev;
+
+  return RC_SUCCESS;
+
+  CATCH_END;
+
+  return RC_FAIL;
+}
+
+void evictor_destroy( evictor_t * ev )
+{
+  free( ev );
+}
+
+void evictor_insert( evictor_t * ev, dlist_node_t * node )
+{
+  atomic_store_rlx( &(evict_meta_of( ev, node )->word), 0 );
+
+  if( ev->ops->on_insert != NULL )
+    {
+      ev->ops->on_insert( ev, evict_meta_of( ev, node ) );
+    }
+}
+
+void evictor_access( evictor_t * ev, dlist_node_t * node )
+{
+  if( ev->ops->on_access != NULL )
+    {
+      ev->ops->on_access( ev, evict_meta_of( ev, node ) );
+    }
+}
+
+void evictor_forget( evictor_t * ev, dlist_node_t * node )
+{
+  if( ev->ops->on_evict != NULL )
+    {
+      ev->ops->on_evict( ev, evict_meta_of( ev, node ) );
+    }
+}
+
+int64_t evictor_resident( evictor_t * ev )
+{
+  return counter_read( &(ev->a1) ) + counter_read( &(ev->am) );
+}
+
+static void evictor_revolution( evictor_t * ev )
+{
+  if( ev->visited > 0 )
+    {
+      ev->revolutions++;
+      ev->starved = ( ev->found == true ) ? false : true;
+      if( ev->ops->on_revolution != NULL )
+        {
+          ev->ops->on_revolution( ev );
+        }
+    }
+
+  ev->found   = false;
+  ev->visited = 0;
+}
+
+dlist_node_t * evictor_next( evictor_t * ev, uint32_t budget )
+{
+  dlist_node_t * node = NULL;
+  uint32_t       i    = 0;
+
+  if( ev->hand_open == false )
+    {
+      TRY( dlist_cursor_open( ev->hand, ev->l, DL_CURSOR_DIR_FORWARD ) != RC_SUCCESS );
+      ev->anchor_hazard = epoch_hazard_alloc();
+      ev->anchor        = NULL;
+      ev->hand_open     = true;
+    }
+
+  if( ev->anchor != NULL &&
+      ev->hand->cur_node != ev->hand->head &&
+      lf_dlist_marked_next( ev->hand->cur_node ) &&
+      ( ev->hand->last_node == NULL || lf_dlist_marked_next( ev->hand->last_node ) ) )
+    {
+      /* the last victims were unlinked: rather than from the head, go on */
+      /* after the last node passed */
+      dlist_cursor_seek( ev->hand, ev->anchor );
+    }
+
+  for( i = 0 ; i < budget ; i++ )
+    {
+      node = dlist_cursor_next( ev->hand );
+      if( node == NULL || dlist_cursor_is_eol( ev->hand ) == true )
+        {
+          /* back to the head: stop here, the victims returned since the */
+          /* last stop may not be unlinked yet */
+          evictor_revolution( ev );
+          ev->anchor = NULL;
+          dlist_cursor_reset( ev->hand );
+          break;
+        }
+
+      ev->visited++;
+      if( ev->ops->on_visit( ev, evict_meta_of( ev, node ) ) == true &&
+          ( ev->admit == NULL || ev->admit( node, ev->admit_ctx ) == true ) )
+        {
+          if( ev->ops->on_evict != NULL )
+            {
+              ev->ops->on_evict( ev, evict_meta_of( ev, node ) );
+            }
+          ev->found = true;
+          return node;
+        }
+
+      if( ev->anchor_hazard >= 0 )
+        {
+          /* published while the hand's own hazard pointer still holds it */
+          epoch_hazard_set( ev->anchor_hazard, (void *)node );
+          ev->anchor = node;
+        }
+    }
+
+  return NULL;
+
+  CATCH_END;
+
+  return NULL;
+}
+
+void evictor_release( evictor_t * ev )
+{
+  if( ev->hand_open == true )
+    {
+      dlist_cursor_close( ev->hand );
+      epoch_hazard_release( ev->anchor_hazard );
+      ev->anchor_hazard = -1;
+      ev->anchor        = NULL;
+      ev->hand_open     = false;
+    }
+}
@@ -0,0 +1,136 @@
+#ifndef _EVICT_H_
+#define _EVICT_H_ 1
+
+#include <stdint.h>
+#include <stddef.h>
+#include "util.h"
+#include "atomic.h"
+#include "counter.h"
+#include "lock_free_dlist.h"
+
+/* ****************************************************************************
+ * Eviction engine over a lock-free list.
+ *
+ * A hand (a cursor, see lock_free_dlist.h) sweeps the list round and round
+ * and asks the policy about every node it passes: skip it, possibly after
+ * updating its state, or take it as the victim. The hand stays where it
+ * stopped between two calls, so a victim costs the nodes skipped since the
+ * previous one: amortised O(1) as long as the policy clears what a node
+ * earned with its accesses while passing it (second chance, decayed
+ * frequency). The engine does not unlink victims, the caller does.
+ *
+ * The per-node state of the policy is an evict_meta_t embedded in the
+ * user's node, found at a fixed offset from the list node. Accesses update
+ * it from any thread with a CAS or two; everything else runs on the one
+ * evicting thread.
+ *
+ * Built-in policies:
+ *   clock  second chance: a reference bit set on access, cleared by the hand
+ *   lfu    access frequency (16 bits) halved once per hand revolution and
+ *          decremented by every pass of the hand; 0 is a victim
+ *   2q     simplified 2Q: a node enters A1 (FIFO) and moves to Am (CLOCK)
+ *          on its second access; A1 is evicted first while it holds more
+ *          than 1/EVICT_2Q_A1_SHARE of the nodes. Keys of evicted nodes are
+ *          not remembered (no A1out ghost queue). */
+
+typedef enum _evict_policy evict_policy_t;
+enum _evict_policy
+{
+  EVICT_POLICY_CLOCK = 0,
+  EVICT_POLICY_LFU   = 1,
+  EVICT_POLICY_2Q    = 2,
+  EVICT_POLICY_MAX
+};
+
+#define EVICT_2Q_A1_SHARE  4
+
+typedef struct _evict_meta evict_meta_t;
+struct _evict_meta
+{
+  uint64_t ATOMIC_VAR  word;  /* cleared by evictor_insert() */
+};
+
+typedef struct _evictor evictor_t;
+
+/* Policy interface: [on_insert] and [on_access] may run on any thread,
+ * [on_visit] and [on_revolution] on the evicting one. [on_evict] runs on
+ * the evicting thread for a victim and on the one calling evictor_forget()
+ * for a node deleted by other means, possibly both for the same node: it
+ * counts each node once. [on_visit] returns true to take the node as the
+ * victim; the other hooks may be NULL. */
+typedef struct _evict_ops evict_ops_t;
+struct _evict_ops
+{
+  const char * name;
+  void (*on_insert)( evictor_t * ev, evict_meta_t * meta );
+  void (*on_access)( evictor_t * ev, evict_meta_t * meta );
+  bool (*on_visit)( evictor_t * ev, evict_meta_t * meta );
+  void (*on_evict)( evictor_t * ev, evict_meta_t * meta );
+  void (*on_revolution)( evictor_t * ev );
+};
+
+/* Called on the node the policy chose: true if it may go now. It may also
+ * record that it is going (e.g. a state change of the node). */
+typedef bool (*evict_admit_fn_t)( dlist_node_t * node, void * ctx );
+
+struct _evictor
+{
+  lf_dlist_t        * l;
+  const evict_ops_t * ops;
+  size_t              meta_offset;  /* of the evict_meta_t in a node */
+  evict_admit_fn_t    admit;
+  void              * admit_ctx;
+  dlist_cursor_t      hand[1];
+  bool                hand_open;
+  /* the last node the hand passed without taking it, where it goes on if */
+  /* the victims it stopped on were unlinked since */
+  dlist_node_t      * anchor;
+  int32_t             anchor_hazard;
+  /* hand revolutions, and whether the last one found no victim */
+  uint64_t            revolutions;
+  uint64_t            visited;  /* nodes passed in this revolution */
+  bool                starved;
+  bool                found;
+  /* lfu: decay epoch, the low 48 bits are stamped on the nodes */
+  uint64_t ATOMIC_VAR decay;
+  /* 2q: nodes in A1 and in Am */
+  counter_t           a1;
+  counter_t           am;
+};
+
+const evict_ops_t * evict_policy_ops( evict_policy_t policy );
+const char * evict_policy_name( evict_policy_t policy );
+evict_policy_t evict_policy_parse( const char * name );
+
+int32_t evictor_create( evictor_t        ** ev,
+                        lf_dlist_t        * l,
+                        const evict_ops_t * ops,
+                        size_t              meta_offset,
+                        evict_admit_fn_t    admit,
+                        void              * admit_ctx );
+void evictor_destroy( evictor_t * ev );
+
+/* [node] is about to be linked into the list / was read */
+void evictor_insert( evictor_t * ev, dlist_node_t * node );
+void evictor_access( evictor_t * ev, dlist_node_t * node );
+/* [node] left the list by another way than as a victim of evictor_next()
+ * (lf_dlist_delete(), dlist_cursor_remove(), take_*, transfer_*): every
+ * such removal must be reported, or the occupancy counts of the policy
+ * (2q: A1 and Am) stay too high for good and skew its choices. Any thread,
+ * before the node is reinserted; reporting a victim again is harmless. */
+void evictor_forget( evictor_t * ev, dlist_node_t * node );
+/* Nodes the policy counts as in the list: A1 + Am for 2q, 0 for the
+ * policies that keep no counts. Exact once the operations are done. */
+int64_t evictor_resident( evictor_t * ev );
+
+/* Move the hand on to the next victim, passing at most [budget] nodes;
+ * NULL if there was none, or if the hand got back to the head: the caller
+ * unlinks the victims it got before going on after a NULL, or the hand may
+ * come across them again. A victim stays linked, protected by the hand,
+ * until the caller unlinks it. The hand belongs to the thread calling
+ * evictor_next(): that thread closes it with evictor_release() when done,
+ * before evictor_destroy(). */
+dlist_node_t * evictor_next( evictor_t * ev, uint32_t budget );
+void evictor_release( evictor_t * ev );
+
+#endif /* _EVICT_H_ */
@@ -0,0 +1,399 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "atomic.h"
+#include "counter.h"
+#include "epoch.h"
+#include "hash_index.h"
+#include "util.h"
+
+#define HASH_INDEX_MARK  ((uint64_t)0x1)
+
+#define hash_index_ptr( _link ) \
+  ((hash_entry_t *)((uint64_t)(_link) & ~HASH_INDEX_MARK))
+#define hash_index_marked( _link ) \
+  ((((uint64_t)(_link)) & HASH_INDEX_MARK) ? true : false)
+
+typedef struct _hash_entry hash_entry_t;
+struct _hash_entry
+{
+  uint64_t                   so_key;  /* split-order key, odd for entries */
+  int64_t                    key;
+  void                     * node;    /* NULL for a bucket sentinel */
+  hash_entry_t * ATOMIC_VAR  next;
+};
+
+typedef struct _hash_segment hash_segment_t;
+struct _hash_segment
+{
+  hash_entry_t * ATOMIC_VAR  buckets[HASH_INDEX_SEGMENT_SIZE];
+};
+
+struct _hash_index
+{
+  uint64_t ATOMIC_VAR         size;   /* buckets in use, a power of 2 */
+  char                        pad[64 - sizeof(uint64_t)];
+  counter_t                   count;  /* entries */
+  hash_segment_t * ATOMIC_VAR segments[HASH_INDEX_SEGMENT_MAX];
+} __attribute__((aligned(64)));
+
+/* a bijection: distinct keys never collide */
+static uint64_t hash_index_hash( int64_t key )
+{
+  return splitmix64( (uint64_t)key );
+}
+
+static uint64_t hash_index_reverse( uint64_t v )
+{
+  v = ((v >> 1) & 0x5555555555555555ULL) | ((v & 0x5555555555555555ULL) << 1);
+  v = ((v >> 2) & 0x3333333333333333ULL) | ((v & 0x3333333333333333ULL) << 2);
+  v = ((v >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((v & 0x0F0F0F0F0F0F0F0FULL) << 4);
+  return __builtin_bswap64( v );
+}
+
+/* The sentinel of a bucket sorts in front of every entry of that bucket */
+#define hash_index_so_entry( _hash )     (hash_index_reverse( _hash ) | 1)
+#define hash_index_so_sentinel( _bucket ) hash_index_reverse( _bucket )
+
+/* order of the list: split-order key, then key, then node address */
+static int32_t hash_index_cmp( hash_entry_t * e, uint64_t so_key, int64_t key, void * node )
+{
+  if( e->so_key != so_key )
+    {
+      return ( e->so_key < so_key ) ? -1 : 1;
+    }
+  if( e->key != key )
+    {
+      return ( e->key < key ) ? -1 : 1;
+    }
+  if( e->node != node )
+    {
+      return ( (uint64_t)e->node < (uint64_t)node ) ? -1 : 1;
+    }
+  return 0;
+}
+
+/* Position of (so_key, key, node) in the list from [start]: [*pred] is the
+ * last entry below it, [*curr] the first one not below it (or NULL).
+ * Removed entries met on the way are unlinked. */
+static void hash_index_find( hash_entry_t  * start,
+                             uint64_t        so_key,
+                             int64_t         key,
+                             void          * node,
+                             hash_entry_t ** _pred,
+                             hash_entry_t ** _curr )
+{
+  hash_entry_t * pred = NULL;
+  hash_entry_t * curr = NULL;
+  hash_entry_t * succ = NULL;
+
+label_retry:
+  pred = start;
+  curr = hash_index_ptr( atomic_load_acq( &(pred->next) ) );
+
+  while( curr != NULL )
+    {
+      succ = atomic_load_acq( &(curr->next) );
+      if( hash_index_marked( succ ) )
+        {
+          if( atomic_cas_ptr( &(pred->next), curr, hash_index_ptr( succ ) ) == false )
+            {
+              goto label_retry;
+            }
+          curr = hash_index_ptr( succ );
+          continue;
+        }
+
+      if( hash_index_cmp( curr, so_key, key, node ) >= 0 )
+        {
+          break;
+        }
+
+      pred = curr;
+      curr = hash_index_ptr( succ );
+    }
+
+  *_pred = pred;
+  *_curr = curr;
+}
+
+/* Link [e] behind [start]; returns [e], or the equal entry already there */
+static hash_entry_t * hash_index_list_insert( hash_entry_t * start, hash_entry_t * e )
+{
+  hash_entry_t * pred = NULL;
+  hash_entry_t * curr = NULL;
+
+  while( true )
+    {
+      hash_index_find( start, e->so_key, e->key, e->node, &pred, &curr );
+      if( curr != NULL && hash_index_cmp( curr, e->so_key, e->key, e->node ) == 0 )
+        {
+          return curr;
+        }
+
+      atomic_store_rlx( &(e->next), curr );
+      if( atomic_cas_ptr( &(pred->next), curr, e ) )
+        {
+          return e;
+        }
+    }
+}
+
+static hash_entry_t * ATOMIC_VAR * hash_index_bucket( hash_index_t * idx, uint64_t bucket )
+{
+  hash_segment_t * seg = NULL;
+  hash_segment_t * new_seg = NULL;
+  uint64_t         seg_idx = bucket / HASH_INDEX_SEGMENT_SIZE;
+
+  seg = atomic_load_acq( &(idx->segments[seg_idx]) );
+  if( seg == NULL )
+    {
+      new_seg = (hash_segment_t *)calloc( 1, sizeof(hash_segment_t) );
+      if( new_seg == NULL )
+        {
+          return NULL;
+        }
+
+      if( atomic_cas_ptr( &(idx->segments[seg_idx]), seg, new_seg ) )
+        {
+          seg = new_seg;
+        }
+      else
+        {
+          free( new_seg );
+          seg = atomic_load_acq( &(idx->segments[seg_idx]) );
+        }
+    }
+
+  return &(seg->buckets[bucket % HASH_INDEX_SEGMENT_SIZE]);
+}
+
+/* Sentinel of [bucket], inserted behind the one of its parent bucket (the
+ * bucket without its most significant bit) if it is not there yet */
+static hash_entry_t * hash_index_sentinel( hash_index_t * idx, uint64_t bucket )
+{
+  hash_entry_t * ATOMIC_VAR * slot = NULL;
+  hash_entry_t * sentinel = NULL;
+  hash_entry_t * parent   = NULL;
+  hash_entry_t * e        = NULL;
+
+  slot = hash_index_bucket( idx, bucket );
+  TRY( slot == NULL );
+
+  sentinel = atomic_load_acq( slot );
+  if( sentinel != NULL )
+    {
+      return sentinel;
+    }
+
+  parent = hash_index_sentinel( idx, bucket & ~((uint64_t)1 << (63 - __builtin_clzll( bucket ))) );
+  TRY( parent == NULL );
+
+  e = (hash_entry_t *)calloc( 1, sizeof(hash_entry_t) );
+  TRY( e == NULL );
+  e->so_key = hash_index_so_sentinel( bucket );
+
+  sentinel = hash_index_list_insert( parent, e );
+  if( sentinel != e )
+    {
+      /* another thread inserted it first */
+      free( e );
+    }
+  atomic_store_rel( slot, sentinel );
+
+  return sentinel;
+
+  CATCH_END;
+
+  return NULL;
+}
+
+int32_t hash_index_create( hash_index_t ** _idx, uint32_t buckets )
+{
+  hash_index_t * idx  = NULL;
+  hash_entry_t * head = NULL;
+  uint64_t       size = 1;
+
+  TRY( _idx == NULL );
+
+  while( size < buckets &&
+         size < (uint64_t)HASH_INDEX_SEGMENT_SIZE * HASH_INDEX_SEGMENT_MAX )
+    {
+      size <<= 1;
+    }
+
+  TRY( posix_memalign( (void **)&idx, 64, sizeof(hash_index_t) ) != 0 );
+  memset( (void *)idx, 0x00, sizeof(hash_index_t) );
+  counter_init( &(idx->count) );
+  idx->size = size;
+
+  /* the sentinel of bucket 0 heads the list */
+  head = (hash_entry_t *)calloc( 1, sizeof(hash_entry_t) );
+  TRY( head == NULL );
+  TRY( hash_index_bucket( idx, 0 ) == NULL );
+  atomic_store_rlx( hash_index_bucket( idx, 0 ), head );
+
+  *_idx = idx;
+
+  return RC_SUCCESS;
+
+  CATCH_END;
+
+  if( idx != NULL )
+    {
+      free( idx->segments[0] );
+      free( idx );
+    }
+  free( head );
+
+  return RC_FAIL;
+}
+
+void hash_index_destroy( hash_index_t * idx )
+{
+  hash_entry_t * e    = NULL;
+  hash_entry_t * next = NULL;
+  int32_t        i    = 0;
+
+  if( idx == NULL )
+    {
+      return;
+    }
+
+  /* the sentinels are in the list as well */
+  for( e = atomic_load_rlx( hash_index_bucket( idx, 0 ) ) ; e != NULL ; e = next )
+    {
+      next = hash_index_ptr( atomic_load_rlx( &(e->next) ) );
+      free( e );
+    }
+
+  for( i = 0 ; i < HASH_INDEX_SEGMENT_MAX ; i++ )
+    {
+      free( idx->segments[i] );
+    }
+
+  free( idx );
+}
+
+int32_t hash_index_add( hash_index_t * idx, int64_t key, void * node )
+{
+  hash_entry_t * sentinel = NULL;
+  hash_entry_t * e    = NULL;
+  uint64_t       hash = hash_index_hash( key );
+  uint64_t       size = atomic_load_acq( &(idx->size) );
+
+  sentinel = hash_index_sentinel( idx, hash & (size - 1) );
+  TRY( sentinel == NULL );
+
+  e = (hash_entry_t *)calloc( 1, sizeof(hash_entry_t) );
+  TRY( e == NULL );
+  e->so_key = hash_index_so_entry( hash );
+  e->key    = key;
+  e->node   = node;
+
+  if( hash_index_list_insert( sentinel, e ) != e )
+    {
+      free( e );
+      return RC_SUCCESS;
+    }
+
+  counter_add( &(idx->count), 1 );
+
+  /* grow: the new buckets get their sentinels when they are first used */
+  if( counter_read_approx( &(idx->count) ) > (int64_t)(size * HASH_INDEX_LOAD_FACTOR) &&
+      size < (uint64_t)HASH_INDEX_SEGMENT_SIZE * HASH_INDEX_SEGMENT_MAX )
+    {
+      (void)atomic_cas_ptr( &(idx->size), size, size << 1 );
+    }
+
+  return RC_SUCCESS;
+
+  CATCH_END;
+
+  return RC_FAIL;
+}
+
+void hash_index_remove( hash_index_t * idx, int64_t key, void * node )
+{
+  hash_entry_t * sentinel = NULL;
+  hash_entry_t * pred = NULL;
+  hash_entry_t * curr = NULL;
+  hash_entry_t * succ = NULL;
+  uint64_t       hash = hash_index_hash( key );
+  uint64_t       so_key = hash_index_so_entry( hash );
+
+  sentinel = hash_index_sentinel( idx, hash & (atomic_load_acq( &(idx->size) ) - 1) );
+  if( sentinel == NULL )
+    {
+      return;
+    }
+
+  hash_index_find( sentinel, so_key, key, node, &pred, &curr );
+  if( curr == NULL || hash_index_cmp( curr, so_key, key, node ) != 0 )
+    {
+      return;
+    }
+
+  while( true )
+    {
+      succ = atomic_load_acq( &(curr->next) );
+      if( hash_index_marked( succ ) )
+        {
+          /* removed by someone else */
+          return;
+        }
+
+      if( atomic_cas_ptr( &(curr->next),
+                          succ,
+                          (hash_entry_t *)((uint64_t)succ | HASH_INDEX_MARK) ) )
+        {
+          break;
+        }
+    }
+
+  counter_add( &(idx->count), -1 );
+
+  /* a marked entry is never linked again: once this search has passed */
+  /* it, it is unreachable */
+  hash_index_find( sentinel, so_key, key, node, &pred, &succ );
+  (void)epoch_retire( (void *)curr, free );
+}
+
+void * hash_index_lookup( hash_index_t * idx, int64_t key )
+{
+  hash_entry_t * e    = NULL;
+  hash_entry_t * next = NULL;
+  uint64_t       hash = hash_index_hash( key );
+  uint64_t       so_key = hash_index_so_entry( hash );
+
+  e = hash_index_sentinel( idx, hash & (atomic_load_acq( &(idx->size) ) - 1) );
+  if( e == NULL )
+    {
+      return NULL;
+    }
+
+  /* read only: step over removed entries rather than unlinking them */
+  for( e = hash_index_ptr( atomic_load_acq( &(e->next) ) ) ; e != NULL ; e = next )
+    {
+      next = atomic_load_acq( &(e->next) );
+      if( e->so_key > so_key )
+        {
+          break;
+        }
+
+      if( e->so_key == so_key && e->key == key && hash_index_marked( next ) == false )
+        {
+          return e->node;
+        }
+
+      next = hash_index_ptr( next );
+    }
+
+  return NULL;
+}
+
+uint64_t hash_index_bucket_count( hash_index_t * idx )
+{
+  return atomic_load_rlx( &(idx->size) );
+}
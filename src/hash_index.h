@@ -0,0 +1,43 @@
+#ifndef _HASH_INDEX_H_
+#define _HASH_INDEX_H_ 1
+
+#include <stdint.h>
+#include "util.h"
+
+/* ****************************************************************************
+ * Lock-free hash index of (key, node) entries: split-ordered list
+ * (Shalev & Shavit, "Split-ordered lists: lock-free extensible hash tables").
+ *
+ * All entries are in one lock-free linked list (removed mark in the lowest
+ * bit of the next pointer), sorted by the bit-reversed hash of their key.
+ * A bucket points to a sentinel entry of that list, so doubling the number
+ * of buckets moves no entry: the sentinel of a new bucket is inserted
+ * lazily, when the bucket is first used, behind the sentinel of its parent.
+ * The bucket array is a directory of segments allocated on demand.
+ *
+ * Removed entries are freed through epoch_retire(): all calls must be made
+ * inside an epoch critical section (epoch.h). The index never reads the
+ * nodes. */
+
+#define HASH_INDEX_SEGMENT_SIZE  1024            /* buckets per segment */
+#define HASH_INDEX_SEGMENT_MAX   4096            /* up to 4M buckets */
+#define HASH_INDEX_LOAD_FACTOR   2               /* entries per bucket */
+
+typedef struct _hash_index hash_index_t;
+
+/* [buckets] is the initial number of buckets, rounded up to a power of 2 */
+int32_t hash_index_create( hash_index_t ** idx, uint32_t buckets );
+/* Frees every entry: no concurrent users, retired entries already freed */
+void hash_index_destroy( hash_index_t * idx );
+
+/* Adding an entry that is already there does nothing */
+int32_t hash_index_add( hash_index_t * idx, int64_t key, void * node );
+void hash_index_remove( hash_index_t * idx, int64_t key, void * node );
+
+/* Node of an entry of [key], NULL if there is none. Of several entries of
+ * the same key, the one of the lowest node address is returned. */
+void * hash_index_lookup( hash_index_t * idx, int64_t key );
+
+uint64_t hash_index_bucket_count( hash_index_t * idx );
+
+#endif /* _HASH_INDEX_H_ */
@@ -1,16 +1,22 @@
 #include <stdio.h>
 #include <pthread.h>
 #include <stdlib.h>
+#include <string.h>
 #include <libgen.h>
 #include <unistd.h>
 #include <sched.h>
 #include <sys/errno.h>
 #include <signal.h>
 #include <getopt.h>
+#include <time.h>
 
 #include "util.h"
 #include "atomic.h"
 #include "lock_free_dlist.h"
+#include "evict.h"
+#include "striped_dlist.h"
+#include "relaxed_dlist.h"
+#include "parallel_dlist.h"
 
 // #define DEBUG 1
 
@@ -19,6 +25,11 @@
 #define THRESHOLD_WORKING_SLOW_AGER     64
 
 #define MIN_ARGC   4
+#define MAX_INSERT_BATCH  64
+#define EVICT_RUN_MAX     64   /* nodes unlinked by one delete_range */
+#define EVICT_HAND_BUDGET 1024 /* nodes the hand passes to find one victim */
+#define AGING_TAKE_MAX    4096 /* nodes the ager detaches at once */
+#define SWEEP_EVERY_ROUNDS  256 /* ager rounds between two parallel sweeps */
 int32_t THR_NUM_INSERT        = 1;
 int32_t THR_NUM_READ          = 1;
 const int32_t THR_NUM_EVICTOR = 1;
@@ -32,6 +43,7 @@ typedef void * (*thread_func_t) ( void * arg );
 volatile int32_t  g_next_key =   -1;
 volatile int32_t  g_delete_cnt = 0;
 volatile int32_t  MAX_ITEM_CNT = 0;
+int32_t           g_insert_batch = 1;
 
 volatile bool     g_exit_flag = false;
 volatile int32_t  g_created_thread_cnt = 0;
@@ -129,14 +141,13 @@ char g_state_str[DLIST_NODE_STATE_MAX+1][16] =
 };
 
 
-// 'read_latch' just define to int32_t type, because we can use atomic functions.
-// However it does not support recovery feature,
-// so that 'read_latch' should be replaced another  sync tool as like pthread_mutex_t.
+// readers do not latch a node in the node itself: a reader announces the
+// node it reads in a hazard slot of its own (see data_list_node_has_readers)
 #define DATA_LIST_NODE_DEFINE_MEMBER_VARS       \
   volatile  int32_t            key;             \
   volatile  int32_t            read_cnt;        \
-  volatile  int32_t            read_latch;      \
-  volatile  dlist_node_state_t state
+  volatile  dlist_node_state_t state;           \
+  evict_meta_t                 evict
 
 typedef volatile struct _aging_list_node _aging_list_node_t;
 #define aging_list_node_t volatile _aging_list_node_t
@@ -160,25 +171,34 @@ struct _data_list_node
   DATA_LIST_NODE_DEFINE_MEMBER_VARS;
 };
 
-bool data_list_node_is_read_latched( data_list_node_t * node )
+/* true if a reader other than the caller is on [node]: consuming it, or
+ * with its cursor stopped there. Readers write only their own hazard slots;
+ * the scan over all of them is paid by the asking writer. */
+bool data_list_node_has_readers( data_list_node_t * node )
 {
-  return (node->read_latch != 0) ? true : false;
+  return epoch_hazard_held( (const void *)node );
 }
 
-typedef volatile struct _data_table data_table_t;
+typedef struct _data_table data_table_t;
+
+/* node counts maintained by the lists; the approximate read is cheap to
+ * poll and never bounces the counter shards of the writers */
+#define data_list_count( _t ) \
+  ((int32_t)lf_dlist_size_approx( (_t)->list ))
+#define aging_list_count( _t ) \
+  ((int32_t)lf_dlist_relaxed_size_approx( (_t)->aging ))
 struct _data_table
 {
-  volatile lf_dlist_t     list[1];       // entry pointer of list
-  volatile lf_dlist_t     aging_list[1]; // entry pointer of aging list
+  lf_dlist_t              list[1];       // entry pointer of list
+  /* aging list: FIFO relaxed over the lanes (-a), each one an lf_dlist_t */
+  /* linked through ag_prev/ag_next */
+  lf_dlist_relaxed_t    * aging;
 
   volatile data_list_node_t    lhead[1];     // list head
   volatile data_list_node_t    ltail[1];
 
-  volatile aging_list_node_t    ahead[1];     // aging list head
-  volatile aging_list_node_t    atail[1];
-
-  volatile int32_t data_list_count;
-  volatile int32_t aging_list_count;
+  node_pool_t    * pool;  // NULL with NODE_ALLOC_MALLOC
+  evictor_t      * evictor;  // victims of t.list
 };
 
 // data_list_node_t to aging list node(dlist_node_t)
@@ -205,6 +225,12 @@ struct _data_table
   (((lf_dlist_get_next( (_l), (_l)->head ) == (_l)->tail) && \
     (lf_dlist_get_prev( (_l), (_l)->tail ) == (_l)->head)) ? true : false )
 
+/* empty without any repair: the deletes left head and tail linked to each
+ * other in both directions (get_next/get_prev above would fix them up) */
+#define dlist_is_empty_settled( _l ) \
+  (((lf_dlist_link_strip( (_l)->head->next ) == (_l)->tail) && \
+    (lf_dlist_link_strip( (_l)->tail->prev ) == (_l)->head)) ? true : false )
+
 #define DLIST_ITERATE( _cursor )             \
   for( dlist_cursor_next( (_cursor) ) ;         \
        (dlist_cursor_is_eol(_cursor ) != true) && ((_cursor)->cur_node != NULL) ; \
@@ -221,8 +247,11 @@ struct _data_table
 #define DLIST_ITERATE_BACK_FROM( _cursor )   \
   DLIST_ITERATE_BACK( _cursor )
 
-#define data_list_key_cmp( _key1, _node ) \
-  ((_key1) - ((data_list_node_t *)(_node))->key)
+/* key function of t.list (lf_dlist_set_key_fn()) */
+static int64_t data_list_node_key( dlist_node_t * node )
+{
+  return (int64_t)((data_list_node_t *)node)->key;
+}
 
 typedef struct _thr_arg thr_arg_t;
 struct _thr_arg
@@ -241,28 +270,157 @@ void * func_evict( void * arg );
 void * func_aging( void * arg );
 int32_t working_threads_create( thr_arg_t * targs );
 int32_t working_threads_join( thr_arg_t * volatile targs, int32_t thr_cnt );
+int32_t working_threads_run( thread_func_t insert_fn,
+                             thread_func_t read_fn,
+                             double      * elapsed );
 int32_t data_list_node_get_state( data_list_node_t * node );
 int32_t data_list_node_set_state( data_list_node_t * node, int32_t state );
 
 int32_t data_table_init( data_table_t ** _t );
 void data_table_finalize( data_table_t * volatile t );
-data_list_node_t * data_table_insert( data_table_t * volatile t, int32_t key );
+int32_t data_table_insert( data_table_t      * volatile t,
+                           int32_t              key,
+                           int32_t              cnt,
+                           data_list_node_t  ** new_nodes );
 bool data_list_check_need_evict( int32_t read_cnt, int32_t cond_read );
-int32_t data_list_evict( volatile data_table_t * t );
+static bool data_list_evict_admit( dlist_node_t * node, void * ctx );
+int32_t data_list_evict( data_table_t * t );
+int32_t data_list_evict_run( data_table_t      * t,
+                             data_list_node_t ** run,
+                             int32_t             run_cnt );
 
 uint64_t data_list_get_total_aging_cnt( void );
-int32_t data_list_delete_evicted( volatile data_table_t * t );
+int32_t data_list_delete_evicted( data_table_t * t );
+int64_t data_list_sweep( data_table_t * t );
 void dump_list( lf_dlist_t * volatile list );
 int32_t working_threads_create( thr_arg_t * targs );
 int32_t working_threads_join( thr_arg_t * volatile targs, int32_t thr_cnt );
 
 volatile uint64_t   g_total_aged_node_cnt = 0;
 volatile bool       g_is_verbose_short = false;
+backoff_policy_t    g_backoff_policy = BACKOFF_EXPONENTIAL;
+
+typedef enum _node_alloc node_alloc_t;
+enum _node_alloc
+{
+  NODE_ALLOC_MALLOC = 0,  // calloc()/free()
+  NODE_ALLOC_POOL   = 1,  // node_pool.h
+  NODE_ALLOC_HUGE   = 2,  // node_pool.h with pre-faulted huge page slabs
+  NODE_ALLOC_MAX
+};
+
+static const char * g_node_alloc_name[NODE_ALLOC_MAX] =
+{
+  "malloc",
+  "pool",
+  "huge"
+};
+
+node_alloc_t        g_node_alloc = NODE_ALLOC_POOL;
+
+typedef enum _index_mode index_mode_t;
+enum _index_mode
+{
+  INDEX_MODE_NONE     = 0,  // readers scan the list with a cursor
+  INDEX_MODE_SKIPLIST = 1,  // readers use lf_dlist_find() on the skip list index
+  INDEX_MODE_HASH     = 2,  // readers use lf_dlist_find() on the hash index
+  INDEX_MODE_MAX
+};
+
+static const char * g_index_mode_name[INDEX_MODE_MAX] =
+{
+  "none",
+  "skiplist",
+  "hash"
+};
+
+index_mode_t        g_index_mode = INDEX_MODE_NONE;
+evict_policy_t      g_evict_policy = EVICT_POLICY_CLOCK;
+/* aging list: lanes and the lane the evictor transfers a run to */
+int32_t             g_aging_lanes = 1;
+lf_dlist_lane_policy_t g_aging_lane_policy = LF_DLIST_LANE_ROUND_ROBIN;
+/* threads of the parallel sweeps of t.list by the ager, 0: none */
+int32_t             g_sweep_threads = 0;
+volatile int32_t    g_sweep_cnt = 0;
+volatile int32_t    g_sweep_bad_cnt = 0;
+
+/* 1 in 2^INDEX_SAMPLE_SHIFT data nodes get into the index */
+#define INDEX_SAMPLE_SHIFT  3
+/* initial buckets of the hash index, it grows with the list */
+#define INDEX_HASH_BUCKETS  1024
+
+typedef enum _deque_mode deque_mode_t;
+enum _deque_mode
+{
+  DEQUE_MODE_NONE  = 0,  // the cache scenario (insert/read/evict/aging)
+  DEQUE_MODE_FIFO  = 1,
+  DEQUE_MODE_LIFO  = 2,
+  DEQUE_MODE_MIXED = 3,
+  DEQUE_MODE_LRU   = 4,
+  DEQUE_MODE_MAX
+};
+
+typedef struct _deque_node deque_node_t;
+struct _deque_node
+{
+  dlist_node_t         link;
+  int32_t              key;
+  volatile int32_t     pop_cnt;
+  volatile int32_t     inserted;  // lru: linked by its insert thread
+  lf_dlist_move_ref_t  ref;       // lru: lf_dlist_move_create()
+};
+
+deque_mode_t        g_deque_mode = DEQUE_MODE_NONE;
+lf_dlist_t          g_deque[1];
+dlist_node_t        g_deque_head[1];
+dlist_node_t        g_deque_tail[1];
+deque_node_t      * g_deque_nodes = NULL;
+volatile int32_t    g_deque_pushed = 0;
+volatile int32_t    g_deque_move_cnt = 0;
+bool                g_deque_combine = false;  // tail appends by lf_dlist_fc_append()
+bool                g_deque_combine_flip = false;  // -f: switch the tail mode every window
+/* -f: appends (passes) per window of the combining tail */
+#define DEQUE_FLIP_WINDOW  16
+/* lru: the first keys are never deleted. Until the evictions start, a */
+/* walk may miss one that moves behind it, or skip it when carried along */
+/* by a move of the node it stands on, but never several walks in a row. */
+#define DEQUE_LRU_PINNED   8
+#define DEQUE_LRU_MISSES   4
+/* lru: ops of the first read thread between two walks */
+#define DEQUE_LRU_WALK     64
+
+deque_mode_t deque_mode_parse( const char * name );
+void * func_deque_push( void * arg );
+void * func_deque_pop( void * arg );
+void * func_deque_lru( void * arg );
+int32_t deque_run( void );
+
+typedef struct _striped_node striped_node_t;
+struct _striped_node
+{
+  dlist_node_t       link;
+  int32_t            key;
+  volatile int32_t   evict_cnt;
+  evict_meta_t       evict;
+};
+
+int32_t              g_stripe_cnt = 0;     // 0: not the striped mode
+int64_t              g_stripe_range = 64;  // keys per block, 0: by hash
+lf_dlist_striped_t * g_striped = NULL;
+striped_node_t     * g_striped_nodes = NULL;
+evictor_t          * g_striped_evictors[LF_DLIST_STRIPE_MAX];
+volatile int32_t     g_striped_appended = 0;
+volatile int32_t     g_striped_evicted = 0;
+volatile int32_t     g_striped_scan_cnt = 0;
+
+void * func_striped_append( void * arg );
+void * func_striped_evict( void * arg );
+int32_t striped_run( void );
 
 #define need_arg_true    true
 #define need_arg_false   false
 
-char *        g_short_options = "tvhi:r:n:";
+char *        g_short_options = "tvhi:r:n:b:k:q:m:x:e:s:w:a:l:cfp:";
 struct option g_long_options[] = {
     {"help",              need_arg_false, 0, 'h'},
 #ifndef FIXED_THREADS
@@ -271,6 +429,19 @@ struct option g_long_options[] = {
 #endif /* FIXED_THREADS */
     {"item-count",        need_arg_true,  0, 'n'},
     {"verbose-simple",    need_arg_false, 0, 'v'},
+    {"backoff",           need_arg_true,  0, 'b'},
+    {"insert-batch",      need_arg_true,  0, 'k'},
+    {"deque",             need_arg_true,  0, 'q'},
+    {"node-alloc",        need_arg_true,  0, 'm'},
+    {"index",             need_arg_true,  0, 'x'},
+    {"evict",             need_arg_true,  0, 'e'},
+    {"stripes",           need_arg_true,  0, 's'},
+    {"stripe-range",      need_arg_true,  0, 'w'},
+    {"aging-lanes",       need_arg_true,  0, 'a'},
+    {"aging-lane",        need_arg_true,  0, 'l'},
+    {"combine",           need_arg_false, 0, 'c'},
+    {"combine-flip",      need_arg_false, 0, 'f'},
+    {"sweep-threads",     need_arg_true,  0, 'p'},
     {0, 0, 0, 0}
 };
 
@@ -281,6 +452,19 @@ enum _option_idx {
   OPT_IDX_THR_READ,
   OPT_IDX_ITEM_COUNT,
   OPT_IDX_VERBOSE_SIMPLE,
+  OPT_IDX_BACKOFF,
+  OPT_IDX_INSERT_BATCH,
+  OPT_IDX_DEQUE,
+  OPT_IDX_NODE_ALLOC,
+  OPT_IDX_INDEX,
+  OPT_IDX_EVICT,
+  OPT_IDX_STRIPES,
+  OPT_IDX_STRIPE_RANGE,
+  OPT_IDX_AGING_LANES,
+  OPT_IDX_AGING_LANE,
+  OPT_IDX_COMBINE,
+  OPT_IDX_COMBINE_FLIP,
+  OPT_IDX_SWEEP_THREADS,
   OPT_IDX_MAX
 };
 
@@ -292,13 +476,26 @@ struct _arg_desc
   char *  desc;
 };
 
-arg_desc_t g_arg_desc[OPT_IDX_MAX + 1] = {
+arg_desc_t g_arg_desc[OPT_IDX_MAX + 2] = {
     {OPT_IDX_NULL,           't', "for test printing usage"},
     {OPT_IDX_HELP,           'h', "print help"},
     {OPT_IDX_THR_INSERT,     'i', "count of insert threads"},
     {OPT_IDX_THR_READ,       'r', "count of read threads"},
     {OPT_IDX_ITEM_COUNT,     'n', "count of item that would be inserted and read"},
     {OPT_IDX_VERBOSE_SIMPLE, 'v', "verbose simpley: print aging status only 10 times"},
+    {OPT_IDX_BACKOFF,        'b', "backoff policy: random, exp(default), prop, spin"},
+    {OPT_IDX_INSERT_BATCH,   'k', "items linked per insert (1 ~ " MKSTR(MAX_INSERT_BATCH) "), published as one chain"},
+    {OPT_IDX_DEQUE,          'q', "deque mode: fifo, lifo, mixed; insert threads push, read threads pop; lru"},
+    {OPT_IDX_NODE_ALLOC,     'm', "data node allocator: malloc, pool(default), huge"},
+    {OPT_IDX_INDEX,          'x', "key lookup of read threads: none(default, cursor scan), skiplist, hash"},
+    {OPT_IDX_EVICT,          'e', "eviction policy: clock(default), lfu, 2q"},
+    {OPT_IDX_STRIPES,        's', "striped mode: keys spread over 1 ~ " MKSTR(LF_DLIST_STRIPE_MAX) " shards; insert threads append, read threads evict per shard"},
+    {OPT_IDX_STRIPE_RANGE,   'w', "striped mode: keys per block of a shard (default 64), 0 to shard by hash"},
+    {OPT_IDX_AGING_LANES,    'a', "lanes of the aging list (1 ~ " MKSTR(LF_DLIST_RELAXED_LANE_MAX) ", default 1), FIFO within a lane only"},
+    {OPT_IDX_AGING_LANE,     'l', "aging lane of an evicted run: thread, round-robin(default)"},
+    {OPT_IDX_COMBINE,        'c', "deque mode: tail appends through the adaptive combining tail (cas <-> flat combining)"},
+    {OPT_IDX_COMBINE_FLIP,   'f', "deque mode: -c with thresholds that switch the tail mode every " MKSTR(DEQUE_FLIP_WINDOW) " appends, both ways must happen"},
+    {OPT_IDX_SWEEP_THREADS,  'p', "ager checks the data list with a parallel sweep of 1 ~ " MKSTR(LF_DLIST_PAR_THREAD_MAX) " threads now and then (default 0: never); needs -x skiplist"},
     {OPT_IDX_MAX, ' ', ""}
 };
 
@@ -321,6 +518,9 @@ int32_t main( int32_t argc, char ** argv )
   int32_t     i       = 0;
   int32_t     tid     = 0;
   thr_arg_t * targs = NULL;
+  double      elapsed = 0.0;
+  struct timespec begin_ts;
+  struct timespec end_ts;
 
   pthread_mutex_init( g_mtx, NULL );
 
@@ -371,6 +571,90 @@ int32_t main( int32_t argc, char ** argv )
           g_is_verbose_short = true;
           break;
 
+        case 'b':
+          g_backoff_policy = backoff_policy_parse( optarg );
+          TRY_GOTO( g_backoff_policy == BACKOFF_POLICY_MAX, label_print_usage );
+          break;
+
+        case 'k':
+          g_insert_batch = atoi( optarg );
+          TRY_GOTO( g_insert_batch <= 0 || g_insert_batch > MAX_INSERT_BATCH,
+                    label_print_usage );
+          break;
+
+        case 'q':
+          g_deque_mode = deque_mode_parse( optarg );
+          TRY_GOTO( g_deque_mode == DEQUE_MODE_MAX, label_print_usage );
+          break;
+
+        case 'm':
+          for( g_node_alloc = NODE_ALLOC_MALLOC ;
+               g_node_alloc < NODE_ALLOC_MAX ;
+               g_node_alloc++ )
+            {
+              if( strcmp( optarg, g_node_alloc_name[g_node_alloc] ) == 0 )
+                {
+                  break;
+                }
+            }
+          TRY_GOTO( g_node_alloc == NODE_ALLOC_MAX, label_print_usage );
+          break;
+
+        case 'x':
+          for( g_index_mode = INDEX_MODE_NONE ;
+               g_index_mode < INDEX_MODE_MAX ;
+               g_index_mode++ )
+            {
+              if( strcmp( optarg, g_index_mode_name[g_index_mode] ) == 0 )
+                {
+                  break;
+                }
+            }
+          TRY_GOTO( g_index_mode == INDEX_MODE_MAX, label_print_usage );
+          break;
+
+        case 'e':
+          g_evict_policy = evict_policy_parse( optarg );
+          TRY_GOTO( g_evict_policy == EVICT_POLICY_MAX, label_print_usage );
+          break;
+
+        case 's':
+          g_stripe_cnt = atoi( optarg );
+          TRY_GOTO( g_stripe_cnt <= 0 || g_stripe_cnt > LF_DLIST_STRIPE_MAX,
+                    label_print_usage );
+          break;
+
+        case 'w':
+          g_stripe_range = atol( optarg );
+          TRY_GOTO( g_stripe_range < 0, label_print_usage );
+          break;
+
+        case 'a':
+          g_aging_lanes = atoi( optarg );
+          TRY_GOTO( g_aging_lanes <= 0 || g_aging_lanes > LF_DLIST_RELAXED_LANE_MAX,
+                    label_print_usage );
+          break;
+
+        case 'l':
+          g_aging_lane_policy = lf_dlist_lane_policy_parse( optarg );
+          TRY_GOTO( g_aging_lane_policy == LF_DLIST_LANE_POLICY_MAX, label_print_usage );
+          break;
+
+        case 'c':
+          g_deque_combine = true;
+          break;
+
+        case 'f':
+          g_deque_combine      = true;
+          g_deque_combine_flip = true;
+          break;
+
+        case 'p':
+          g_sweep_threads = atoi( optarg );
+          TRY_GOTO( g_sweep_threads <= 0 || g_sweep_threads > LF_DLIST_PAR_THREAD_MAX,
+                    label_print_usage );
+          break;
+
         case 'h':
         case '?':
           TRY_GOTO( true, label_print_usage );
@@ -382,6 +666,23 @@ int32_t main( int32_t argc, char ** argv )
   TRY_GOTO( THR_NUM_INSERT == 0, label_print_usage );
   TRY_GOTO( THR_NUM_READ == 0, label_print_usage );
   TRY_GOTO( MAX_ITEM_CNT == 0, label_print_usage );
+  /* the split points of a parallel sweep come from the skip list index */
+  TRY_GOTO( g_sweep_threads > 0 && g_index_mode != INDEX_MODE_SKIPLIST,
+            label_print_usage );
+
+  if( g_deque_mode != DEQUE_MODE_NONE )
+    {
+      TRY_GOTO( deque_run() != RC_SUCCESS, err_deque_run );
+      printf("SUCCESS!\n");
+      return 0;
+    }
+
+  if( g_stripe_cnt > 0 )
+    {
+      TRY_GOTO( striped_run() != RC_SUCCESS, err_striped_run );
+      printf("SUCCESS!\n");
+      return 0;
+    }
 
   /* 2. create data table */
   ret = data_table_init( &tbl );
@@ -445,19 +746,43 @@ int32_t main( int32_t argc, char ** argv )
   pthread_barrier_wait( g_thr_barrier );
   TRY_GOTO( errno != 0, err_wait_barrier );
 #endif
+  clock_gettime( CLOCK_MONOTONIC, &begin_ts );
 
   /* 7. join threads */
   state = 2;
   (void)working_threads_join( targs, THR_NUM_MAX );
 
+  clock_gettime( CLOCK_MONOTONIC, &end_ts );
+  elapsed = (double)(end_ts.tv_sec - begin_ts.tv_sec) +
+    (double)(end_ts.tv_nsec - begin_ts.tv_nsec) / 1e9;
+
   /* A termination condition of ager thread is that 
    *    "produced data count(program args) == free nodes count",
    * So, if this program reaches here, this means all items are produced, consumed
    * and freed correctly */
 
   /* 8. check results */
-  TRY_GOTO( (tbl->data_list_count + tbl->aging_list_count) > 0,
+  TRY_GOTO( (lf_dlist_size( tbl->list ) + lf_dlist_relaxed_size( tbl->aging )) > 0,
             err_bad_works_on_data_list );
+  TRY_GOTO( dlist_is_empty_settled( tbl->list ) != true,
+            err_bad_works_on_data_list );
+  /* every node left through the evictor: the policy counts none */
+  TRY_GOTO( evictor_resident( tbl->evictor ) != 0,
+            err_bad_works_on_data_list );
+  for( i = 0 ; i < g_aging_lanes ; i++ )
+    {
+      TRY_GOTO( dlist_is_empty_settled( lf_dlist_relaxed_lane( tbl->aging, i ) ) != true,
+                err_bad_works_on_data_list );
+    }
+  if( g_sweep_threads > 0 )
+    {
+      TRY_GOTO( data_list_sweep( tbl ) != 0, err_bad_works_on_data_list );
+      TRY_GOTO( g_sweep_bad_cnt != 0, err_bad_works_on_data_list );
+    }
+
+  /* free the nodes retired by the ager that are still waiting for their
+   * grace period (all workers have exited, so it ends at once) */
+  lf_dlist_epoch_barrier();
 
   /* 9. dealloc thr args */
   /* IMPORTANT: free() is system call, so this code line leads
@@ -470,6 +795,23 @@ int32_t main( int32_t argc, char ** argv )
   state = 0;
   data_table_finalize( tbl );
 
+  /* compare engines with `make clean; make ATOMIC=legacy build_test` */
+  printf( "[atomic engine: %s][links: %s][backoff: %s][node alloc: %s][index: %s][evict: %s][aging lanes: %d by %s] elapsed: %.3f sec, throughput: %.0f items/sec\n",
+          ATOMIC_ENGINE_NAME,
+          DL_LINK_MODE_NAME,
+          backoff_policy_name( g_backoff_policy ),
+          g_node_alloc_name[g_node_alloc],
+          g_index_mode_name[g_index_mode],
+          evict_policy_name( g_evict_policy ),
+          g_aging_lanes,
+          lf_dlist_lane_policy_name( g_aging_lane_policy ),
+          elapsed,
+          (elapsed > 0.0) ? (double)MAX_ITEM_CNT / elapsed : 0.0 );
+  if( g_sweep_threads > 0 )
+    {
+      printf( "[sweep] %d parallel sweeps of the data list by %d threads\n",
+              g_sweep_cnt, g_sweep_threads );
+    }
   printf("SUCCESS!\n");
 
   return 0;
@@ -485,7 +827,7 @@ int32_t main( int32_t argc, char ** argv )
                "   options:\n",
                basename(argv[0]) );
 
-      for( i = 0 ; i < OPT_IDX_MAX ; i++ )
+      for( i = 0 ; g_arg_desc[i].long_opt_idx != OPT_IDX_MAX ; i++ )
         {
           long_opt_idx = g_arg_desc[i].long_opt_idx;
           if( long_opt_idx == OPT_IDX_NULL )
@@ -524,19 +866,15 @@ int32_t main( int32_t argc, char ** argv )
                "  ----------------------------------------------\n"
                "    tbl.head[%p].next[%p]\n"
                "    tbl.tail[%p].prev[%p]\n"
-               "    tbl.aging_head[%p].next[%p]\n"
-               "    tbl.aging_tail[%p].prev[%p]\n"
+               "    tbl.aging lanes[%d]\n"
                "  ----------------------------------------------\n",
-               tbl->data_list_count,
-               tbl->aging_list_count,
+               (int32_t)lf_dlist_size( tbl->list ),
+               (int32_t)lf_dlist_relaxed_size( tbl->aging ),
                tbl->list->head,
                tbl->list->head->next,
                tbl->list->tail,
                tbl->list->tail->prev,
-               tbl->aging_list->head,
-               tbl->aging_list->head->next,
-               tbl->aging_list->tail,
-               tbl->aging_list->tail->prev );
+               g_aging_lanes );
       abort();
     }
   CATCH( err_wait_barrier )
@@ -547,6 +885,14 @@ int32_t main( int32_t argc, char ** argv )
     {
       fprintf( stderr, "can not create data table\n" );
     }
+  CATCH( err_deque_run )
+    {
+      fprintf( stderr, "deque run failed\n" );
+    }
+  CATCH( err_striped_run )
+    {
+      fprintf( stderr, "striped run failed\n" );
+    }
   CATCH( err_fail_create_thread )
     {
       fprintf( stderr, "can not create threads \n" );
@@ -575,17 +921,24 @@ int32_t main( int32_t argc, char ** argv )
 
 int32_t insert_data( data_table_t * tbl )
 {
-  data_list_node_t   * volatile node = NULL;;
-  int32_t    key = 0; // atomic_inc_fetch( &g_next_key );
+  data_list_node_t   * nodes[MAX_INSERT_BATCH];
+  int32_t    key = 0;
+  int32_t    cnt = g_insert_batch;
+  int32_t    i   = 0;
 
 #ifdef USING_PTHREAD_MUTEX_ONLY_INSERT
   pthread_mutex_lock( g_mtx );
 #endif /* USING_PTHREAD_MUTEX_ONLY_INSERT */
 
-  key = atomic_inc_fetch( &g_next_key );
+  /* take [cnt] consecutive keys at once */
+  key = (int32_t)lf_dlist_seq_take( tbl->list, (uint32_t)cnt );
   if( key < MAX_ITEM_CNT ) {
-    node = data_table_insert( tbl, key );
-    TRY( node == NULL );
+    if( key + cnt > MAX_ITEM_CNT )
+      {
+        cnt = MAX_ITEM_CNT - key;
+      }
+
+    TRY( data_table_insert( tbl, key, cnt, nodes ) != RC_SUCCESS );
 
 #if 1
     // set some data;
@@ -595,7 +948,10 @@ int32_t insert_data( data_table_t * tbl )
 #endif
 
     // complete and then change state to (reference) available
-    data_list_node_set_state( node, DLIST_NODE_STATE_AVAIL );
+    for( i = 0 ; i < cnt ; i++ )
+      {
+        data_list_node_set_state( nodes[i], DLIST_NODE_STATE_AVAIL );
+      }
   }
 #ifdef USING_PTHREAD_MUTEX_ONLY_INSERT
   pthread_mutex_unlock( g_mtx );
@@ -675,7 +1031,7 @@ void * func_insert( void * arg )
 
   while( g_exit_flag == false )
     {
-      if( g_next_key >= MAX_ITEM_CNT )
+      if( lf_dlist_seq_next( tbl->list ) >= (uint64_t)MAX_ITEM_CNT )
         {
           break;
         }
@@ -699,6 +1055,67 @@ void * func_insert( void * arg )
   return NULL;
 }
 
+/* Move [cursor] back to the last node with a key below [key] (or the head),
+ * so that the next search finds [key] in a few steps. */
+void data_table_search_rewind( dlist_cursor_t * volatile cursor, int32_t key )
+{
+  while( cursor->cur_node != cursor->head )
+    {
+      if( cursor->cur_node == NULL )
+        {
+          cursor->dir = DL_CURSOR_DIR_FORWARD;
+          dlist_cursor_reset( cursor );
+          break;
+        }
+
+      if( cursor->cur_node != cursor->tail &&
+          dlist_cursor_get_list_node( cursor )->key < key )
+        {
+          break;
+        }
+
+      (void)dlist_cursor_prev( cursor );
+    }
+}
+
+/* Index lookup (-x): unlike data_table_search() there is no cursor holding
+ * the node, so the caller stays in an epoch section while it uses [*_node] */
+int32_t data_table_find( data_table_t      * volatile t,
+                         int32_t             key,
+                         data_list_node_t ** volatile _node )
+{
+  data_list_node_t * node = NULL;
+
+  *_node = NULL;
+
+  node = (data_list_node_t *)lf_dlist_find( t->list, key );
+  if( node != NULL )
+    {
+      switch( data_list_node_get_state( node ) )
+        {
+        case DLIST_NODE_STATE_AVAIL:
+          *_node = node;
+          break;
+
+        case DLIST_NODE_STATE_INIT:
+          /* inserted, but not available yet */
+          break;
+
+        default:
+          /* a node in the list cannot be evicted before we read it */
+          print_data_list_node( node );
+          TRY( 1 );
+          break;
+        }
+    }
+
+  return RC_SUCCESS;
+
+  CATCH_END;
+
+  return RC_FAIL;
+}
+
 int32_t data_table_search( data_table_t      * volatile t,
                            dlist_cursor_t     * volatile cursor,
                            int32_t             key,
@@ -709,14 +1126,13 @@ int32_t data_table_search( data_table_t      * volatile t,
   volatile int32_t node_state = 0;
   volatile int32_t _key;
   volatile int32_t upper_key_range;
-  bool is_locked = false;
 
   DLIST_ITERATE( cursor )
     {
       mem_barrier();
+      /* the cursor's hazard pointer already tells writers where we are: */
+      /* nothing is written to the nodes passed */
       node = dlist_cursor_get_list_node( cursor );
-      atomic_inc_fetch( &(node->read_latch) );  // get read lock
-      is_locked = true;
 
       _key = node->key;
 
@@ -761,11 +1177,9 @@ int32_t data_table_search( data_table_t      * volatile t,
           goto label_break_iterate;
         }
 
-      is_locked = false; 
-      atomic_dec_fetch( &(node->read_latch) );  // release read lock
 
-      upper_key_range = ((int32_t)(t->data_list_count) < 128 ) ?
-        (int32_t)(t->data_list_count - 1) : 128;
+      upper_key_range = ((int32_t)(data_list_count( t )) < 128 ) ?
+        (int32_t)(data_list_count( t ) - 1) : 128;
 
       mem_barrier();
 
@@ -779,20 +1193,10 @@ int32_t data_table_search( data_table_t      * volatile t,
 
 label_break_iterate:
 
-  if( is_locked == true )
-    {
-      atomic_dec_fetch( &(node->read_latch) );  // release read lock
-    }
-
   return RC_SUCCESS;
 
   CATCH_END;
 
-  if( is_locked == true )
-    {
-      atomic_dec_fetch( &(node->read_latch) );  // release read lock
-    }
-
   return RC_FAIL;
 }
 
@@ -809,14 +1213,17 @@ void * func_read( void * arg )
   int32_t             break_cnt = 0;
   thr_arg_t         * targ = (thr_arg_t *)arg;
   data_table_t      * volatile tbl = targ->tbl;
-  data_list_node_t  * volatile node = NULL;
+  data_list_node_t  * node = NULL;  // only this thread writes it
   // data_list_node_t  * volatile node = NULL;
   dlist_cursor_t      cursor[1] = {};
+  int32_t             read_slot = -1;
 
   pthread_barrier_wait( g_thr_barrier );
   TRY_GOTO( errno != 0, err_wait_barrier );
 
   dlist_cursor_open( cursor, tbl->list, DL_CURSOR_DIR_FORWARD );
+  /* reader indicator: the node being consumed is published here */
+  read_slot = epoch_hazard_alloc();
 
   while( g_exit_flag == false )
     {
@@ -827,13 +1234,25 @@ void * func_read( void * arg )
 
       node = NULL;
 
-      if( tbl->data_list_count == 0 )
+      if( data_list_count( tbl ) == 0 )
         {
           thread_sleep( 0, 10 );
           continue;
         }
 
-      ret = data_table_search( tbl, cursor, search_key, &node );
+      if( g_index_mode != INDEX_MODE_NONE )
+        {
+          lf_dlist_epoch_enter();
+          ret = data_table_find( tbl, search_key, &node );
+          if( ret == RC_FAIL || node == NULL )
+            {
+              lf_dlist_epoch_exit();
+            }
+        }
+      else
+        {
+          ret = data_table_search( tbl, cursor, search_key, &node );
+        }
       TRY( ret == RC_FAIL );
 
       if( node == NULL )
@@ -845,8 +1264,12 @@ void * func_read( void * arg )
             asm volatile ( "WBINVD" );
           }
 #endif
-          // there is no item to read
-          dlist_cursor_reset( cursor );
+          // there is no item to read: step back in front of it rather
+          // than scanning from the head again
+          if( g_index_mode == INDEX_MODE_NONE )
+            {
+              data_table_search_rewind( cursor, search_key );
+            }
           lf_dlist_backoff( tbl->list );
           continue;
         }
@@ -854,17 +1277,45 @@ void * func_read( void * arg )
         {
           break_cnt = 0;
           // success to get item with 'key'
-          atomic_inc_fetch( &(node->read_latch) );  // get read lock
+          if( read_slot >= 0 )
+            {
+              epoch_hazard_set( read_slot, (void *)node );
+              mem_barrier();  // see epoch_hazard_held()
+              /* evictor 가 먼저 상태를 바꿨다면 우리를 못 봤을 수 있다.
+               * 물러났다가 같은 key 를 다시 찾는다: evictor 가 우리를
+               * 봤다면 상태를 되돌린다. */
+              if( node->state >= DLIST_NODE_STATE_NEED_EVICT )
+                {
+                  epoch_hazard_set( read_slot, NULL );
+                  if( g_index_mode != INDEX_MODE_NONE )
+                    {
+                      lf_dlist_epoch_exit();
+                    }
+                  lf_dlist_backoff( tbl->list );
+                  continue;
+                }
+            }
           _simulate_do_something( tbl, node );
-          atomic_dec_fetch( &(node->read_latch) );  // release read lock
+          if( read_slot >= 0 )
+            {
+              epoch_hazard_set( read_slot, NULL );
+            }
 
+          evictor_access( tbl->evictor, (dlist_node_t *)node );
           atomic_inc_fetch( &(node->read_cnt) );
+          if( g_index_mode != INDEX_MODE_NONE )
+            {
+              lf_dlist_epoch_exit();
+            }
 
           search_key++;  // want to search next key
         }
 
     }
 
+  epoch_hazard_release( read_slot );
+  dlist_cursor_close( cursor );
+
   return NULL;
 
   CATCH( err_wait_barrier )
@@ -873,6 +1324,8 @@ void * func_read( void * arg )
     }
   CATCH_END;
 
+  epoch_hazard_release( read_slot );
+
   return NULL;
 }
 
@@ -890,7 +1343,7 @@ void * func_evict( void * arg )
     {
       evicted_cnt = 0;
 
-      if( tbl->data_list_count > 0 ) {
+      if( data_list_count( tbl ) > 0 ) {
         evicted_cnt = data_list_evict( tbl );
       }
 
@@ -900,6 +1353,9 @@ void * func_evict( void * arg )
         }
     }
 
+  /* the hand holds hazard slots of this thread */
+  evictor_release( tbl->evictor );
+
   return NULL;
 
   CATCH( err_wait_barrier )
@@ -917,24 +1373,32 @@ void * func_aging( void * arg )
   int32_t         ret = 0;
   thr_arg_t     * targ = (thr_arg_t *)arg;
   data_table_t  * tbl = targ->tbl;
+  uint32_t        round = 0;
 
   pthread_barrier_wait( g_thr_barrier );
   TRY_GOTO( errno != 0, err_wait_barrier );
 
   while( g_exit_flag == false )
     {
-      if( tbl->aging_list_count > 0 )
+      if( aging_list_count( tbl ) > 0 )
         {
           ret = data_list_delete_evicted( tbl );
           g_delete_cnt += ret;
 
-          if( g_delete_cnt >= MAX_ITEM_CNT - 5 )
+          /* 삽입과 eviction 이 진행되는 중에 data list 전체를 검사한다 */
+          if( g_sweep_threads > 0 && ++round % SWEEP_EVERY_ROUNDS == 0 )
+            {
+              (void)data_list_sweep( tbl );
+              TRY_GOTO( g_sweep_bad_cnt != 0, err_bad_sweep );
+            }
+
+          if( g_delete_cnt >= MAX_ITEM_CNT )
             {
               g_exit_flag = true;
               break;
             }
 
-          if( tbl->data_list_count == 0 )
+          if( data_list_count( tbl ) == 0 )
             thread_sleep( 0, 10 );
         }
     }
@@ -945,6 +1409,11 @@ void * func_aging( void * arg )
     {
       perror(get_thr_error_prefix(targ->tid, esb));
     }
+  CATCH( err_bad_sweep )
+    {
+      fprintf( stderr, "sweep: %d bad nodes in the data list\n", g_sweep_bad_cnt );
+      abort();
+    }
   CATCH_END;
 
   return NULL;
@@ -957,20 +1426,59 @@ int32_t data_table_init( data_table_t ** _t )
 
   TRY_GOTO( _t == NULL, err_invalid_arg );
 
-  t = (data_table_t *)calloc( 1, sizeof(data_table_t) );
-  TRY_GOTO( t == NULL, err_fail_alloc );
+  /* the lists hold cache line aligned counters */
+  TRY_GOTO( posix_memalign( (void **)&t, 64, sizeof(data_table_t) ) != 0,
+            err_fail_alloc );
+  memset( (void *)t, 0x00, sizeof(data_table_t) );
 
   // list init
   lf_dlist_initiaize( t->list,
                       (dlist_node_t *)t->lhead,
                       (dlist_node_t *)t->ltail,
+                      g_backoff_policy,
                       DLIST_DEFAULT_MAX_BACKOFF_LIST );
 
   // aging list init
-  lf_dlist_initiaize( t->aging_list, 
-                      (dlist_node_t *)data_list_n_to_aging_list_n(t->ahead),
-                      (dlist_node_t *)data_list_n_to_aging_list_n(t->atail),
-                      DLIST_DEFAULT_MAX_BACKOFF_AGING_LIST );
+  TRY_GOTO( lf_dlist_relaxed_create( &(t->aging),
+                                     (uint32_t)g_aging_lanes,
+                                     g_aging_lane_policy,
+                                     g_backoff_policy,
+                                     DLIST_DEFAULT_MAX_BACKOFF_AGING_LIST ) != RC_SUCCESS,
+            err_fail_alloc );
+
+  /* data nodes come from the allocator of t->list; the ager hands them
+   * back through it, so they are recycled to the inserters */
+  if( g_node_alloc != NODE_ALLOC_MALLOC )
+    {
+      TRY_GOTO( node_pool_create( &(t->pool),
+                                  sizeof(data_list_node_t),
+                                  ( g_node_alloc == NODE_ALLOC_HUGE ) ?
+                                  NODE_POOL_HUGE_PAGE | NODE_POOL_POPULATE : 0 )
+                != RC_SUCCESS, err_fail_alloc );
+      lf_dlist_set_node_pool( t->list, t->pool );
+    }
+
+  TRY_GOTO( evictor_create( &(t->evictor),
+                            t->list,
+                            evict_policy_ops( g_evict_policy ),
+                            offsetof(data_list_node_t, evict),
+                            data_list_evict_admit,
+                            NULL ) != RC_SUCCESS, err_fail_alloc );
+
+  lf_dlist_set_key_fn( t->list, data_list_node_key );
+  if( g_index_mode == INDEX_MODE_SKIPLIST )
+    {
+      TRY_GOTO( lf_dlist_index_create( t->list, INDEX_SAMPLE_SHIFT ) != RC_SUCCESS,
+                err_fail_alloc );
+    }
+  else if( g_index_mode == INDEX_MODE_HASH )
+    {
+      TRY_GOTO( lf_dlist_hash_create( t->list, INDEX_HASH_BUCKETS ) != RC_SUCCESS,
+                err_fail_alloc );
+    }
+
+  /* keys are the tickets of the ordered append mode, from 0 */
+  TRY_GOTO( lf_dlist_seq_create( t->list, 0 ) != RC_SUCCESS, err_fail_alloc );
 
   *_t = t;
 
@@ -979,6 +1487,7 @@ int32_t data_table_init( data_table_t ** _t )
   CATCH( err_fail_alloc )
     {
       perror(get_error_prefix(esb));
+      free( t );
     }
   CATCH( err_invalid_arg )
     {
@@ -990,104 +1499,133 @@ int32_t data_table_init( data_table_t ** _t )
   return RC_FAIL;
 }
 
+/* free what is left on [l] (no concurrent users); [hook_offset] is the
+ * offset of l's hook in data_list_node_t */
+static void data_table_drain( data_table_t * volatile t,
+                              lf_dlist_t   * volatile l,
+                              size_t                  hook_offset )
+{
+  dlist_node_t * first = NULL;
+  dlist_node_t * last  = NULL;
+  dlist_node_t * node  = NULL;
+  dlist_node_t * next  = NULL;
+
+  (void)lf_dlist_take_all( l, &first, &last );
+  if( first == NULL )
+    {
+      return;
+    }
+
+  for( node = first ; ; node = next )
+    {
+      next = lf_dlist_dereference_node_pointer_mem_only( node->next );
+      if( l == t->list )
+        {
+          /* taken behind the evictor's back */
+          evictor_forget( t->evictor, node );
+        }
+      lf_dlist_node_free( t->list, (void *)((char *)node - hook_offset) );
+      if( node == last )
+        {
+          break;
+        }
+    }
+}
+
 void data_table_finalize( data_table_t * volatile t )
 {
-  /* omited: free nodes in t.list and t.anging_list */
+  int32_t i = 0;
+
   if( t ) {
+    /* nodes still on the lists after a failed run */
+    data_table_drain( t, t->list, 0 );
+    for( i = 0 ; t->aging != NULL && i < g_aging_lanes ; i++ )
+      {
+        data_table_drain( t,
+                          lf_dlist_relaxed_lane( t->aging, i ),
+                          offsetof(data_list_node_t, ag_prev) );
+      }
+
+    /* all retired nodes must have been freed (lf_dlist_epoch_barrier()) */
+    lf_dlist_index_destroy( t->list );
+    lf_dlist_hash_destroy( t->list );
+    lf_dlist_seq_destroy( t->list );
+    lf_dlist_relaxed_destroy( t->aging );
+    evictor_destroy( t->evictor );
+    node_pool_destroy( t->pool );
     free( t );
   }
 }
 
 /* head | -- (key1) --- (key2) --- (key3) --- ... --- (newest_key) -- | tail */
 
-data_list_node_t * data_table_insert( data_table_t * volatile t, int32_t key )
+/* insert [cnt] new nodes with keys [key, key + cnt) as one chain, at the
+ * tail: [key] is a ticket of the ordered append mode, the chain is linked
+ * after those of every smaller key, possibly by another inserter once this
+ * one has returned */
+int32_t data_table_insert( data_table_t      * volatile t,
+                           int32_t              key,
+                           int32_t              cnt,
+                           data_list_node_t  ** new_nodes )
 {
   char esb[512];
-  data_list_node_t * new_node;
-  data_list_node_t * node;
-  dlist_cursor_t    cursor[1];
+  dlist_node_t     * first = NULL;
+  dlist_node_t     * last  = NULL;
   DL_STATUS         st = 0;
 
-  int32_t  cmp_ret = 0;
-  int32_t  state = 0;
-  bool     is_cursor_open = false;
-  bool     is_inserted = false;
+  int32_t  alloc_cnt = 0;
+  int32_t  i = 0;
 
-  new_node = (data_list_node_t *)calloc(1, sizeof(data_list_node_t) );
-  TRY_GOTO( new_node == NULL, err_alloc_data_list_node );
-  state = 1;
-
-  new_node->key = key;
+  /* build the chain privately, it is published by a single CAS */
+  for( i = 0 ; i < cnt ; i++ )
+    {
+      new_nodes[i] = (data_list_node_t *)lf_dlist_node_alloc( t->list,
+                                                              sizeof(data_list_node_t) );
+      TRY_GOTO( new_nodes[i] == NULL, err_alloc_data_list_node );
+      alloc_cnt++;
+
+      new_nodes[i]->key = key + i;
+      evictor_insert( t->evictor, (dlist_node_t *)new_nodes[i] );
+      lf_dlist_chain_append( &first, &last, (dlist_node_t *)new_nodes[i] );
+    }
 
-label_insert_again:
   mem_barrier();
 #ifdef USING_PTHREAD_MUTEX_ONLY_INSERT
-  st = lf_dlist_insert_before( t->list, t->list->tail, (dlist_node_t *)new_node);
-  TRY_GOTO( st != DL_STATUS_OK, label_insert_again );
+  st = lf_dlist_insert_chain_before( t->list, t->list->tail, first, last );
 #else /* USING_PTHREAD_MUTEX_ONLY_INSERT */
-  TRY( dlist_cursor_open( cursor, t->list, DL_CURSOR_DIR_BACKWARD ) != RC_SUCCESS );
-  is_cursor_open = true;
-
-  for( dlist_cursor_prev( cursor ) ;
-       cursor->cur_node != NULL ;
-       dlist_cursor_prev( cursor ) )
-    {
-      node = dlist_cursor_get_list_node( cursor );
-
-      if( dlist_cursor_is_eol( cursor ) != true )
-        {
-          cmp_ret = data_list_key_cmp( key, node );
-        }
-      else
-        {
-          cmp_ret = 1;
-        }
-
-      if( cmp_ret == 1 )
-        {
-          st = lf_dlist_insert_after( t->list,
-                                      (dlist_node_t *)node,
-                                      (dlist_node_t *)new_node );
-          TRY_GOTO( st != DL_STATUS_OK, label_insert_again );
+  /* no gap to wait for: an earlier key still on its way links ours */
+  st = lf_dlist_seq_append( t->list, (uint64_t)key, (uint32_t)cnt, first, last );
+  /* a failed run stays parked, it is the list's now: do not free it */
+  TRY_GOTO( st != DL_STATUS_OK, err_seq_append );
+#endif /* USING_PTHREAD_MUTEX_ONLY_INSERT */
+  TRY( st != DL_STATUS_OK );
 
-          is_inserted = true;
-          break;
-        }
+  return RC_SUCCESS;
 
-      if( cmp_ret > 1 )
-        {
-          thread_sleep( 0, 10 );
-          goto label_insert_again;
-        }
+#ifndef USING_PTHREAD_MUTEX_ONLY_INSERT
+  CATCH( err_seq_append )
+    {
+      fprintf( stderr, "ordered append of keys %d ~ %d failed: %d\n",
+               key, key + cnt - 1, st );
+      return RC_FAIL;
     }
-
-  TRY( is_inserted == false );
-
-  is_cursor_open = false;
-  dlist_cursor_close( cursor );
 #endif /* USING_PTHREAD_MUTEX_ONLY_INSERT */
-
-  atomic_inc_fetch( &(t->data_list_count) );
-
-  return new_node;
-
   CATCH( err_alloc_data_list_node )
     {
       perror(get_error_prefix(esb));
+#ifndef USING_PTHREAD_MUTEX_ONLY_INSERT
+      /* nothing to link: let the later keys through */
+      (void)lf_dlist_seq_cancel( t->list, (uint64_t)key, (uint32_t)cnt );
+#endif /* USING_PTHREAD_MUTEX_ONLY_INSERT */
     }
   CATCH_END;
 
-  if( is_cursor_open == true )
-    {
-      dlist_cursor_close( cursor );
-    }
-
-  if( state == 1 )
+  for( i = 0 ; i < alloc_cnt ; i++ )
     {
-      free( new_node );
+      lf_dlist_node_free( t->list, (void *)new_nodes[i] );
     }
 
-  return NULL;
+  return RC_FAIL;
 }
 
 bool data_list_check_need_evict( int32_t read_cnt, int32_t cond_read )
@@ -1102,186 +1640,145 @@ bool data_list_check_need_evict( int32_t read_cnt, int32_t cond_read )
     }
 }
 
-int32_t data_list_evict( volatile data_table_t * t )
+/* admit callback of t.evictor: a node goes only once every reader read it */
+static bool data_list_evict_admit( dlist_node_t * _node, void * ctx )
 {
-  volatile data_list_node_t  * volatile node = NULL;
-  volatile dlist_cursor_t     cursor[1] = {};
-  volatile dlist_node_t     * volatile tmp = NULL;
-  volatile dlist_node_t     * volatile cur_node_next = NULL;
-  bool     is_cursor_open = false;
-  int32_t  ret = 0;
-  int32_t  evict_cnt = 0;
-  bool     is_need_evict = false;
+  data_list_node_t * node  = (data_list_node_t *)_node;
+  int32_t            state = 0;
 
-  TRY( dlist_cursor_open( cursor, t->list, DL_CURSOR_DIR_FORWARD ) != RC_SUCCESS );
-  is_cursor_open = true;
+  (void)ctx;
 
-label_try_again:
-  mem_barrier();
-  if( t->data_list_count > 0 )
+  state = node->state;
+  if( state < DLIST_NODE_STATE_NEED_EVICT )
     {
-      (void)dlist_cursor_reset( cursor );
-
-      DLIST_ITERATE( cursor )
+      /* evictor는 퇴거대상인지 검사한 후 '상태 변경' 및 퇴거한다 */
+      if( data_list_check_need_evict( node->read_cnt, THR_NUM_READ ) != true )
         {
-          if( g_exit_flag == true )
-            {
-              break;
-            }
+          return false;
+        }
 
-          node = dlist_cursor_get_list_node( cursor );
+      /* 상태를 먼저 바꾸고 리더를 확인한다 (epoch_hazard_held() 참고):
+       * 리더가 바뀐 상태를 보고 물러나거나, 우리가 리더를 본다. */
+      if( atomic_cas_32( &(node->state), state, DLIST_NODE_STATE_NEED_EVICT ) != state )
+        {
+          return false;
+        }
 
-          if( node->state < DLIST_NODE_STATE_NEED_EVICT )
-            {
-              /* evictor는 퇴거대상인지 검사한 후 '상태 변경' 및 퇴거한다 */
-              is_need_evict = data_list_check_need_evict( node->read_cnt, THR_NUM_READ );
-              if( is_need_evict == true )
-                {
-                  do {
-                    ret = data_list_node_set_state( node, DLIST_NODE_STATE_NEED_EVICT );
-                  } while( ret != RC_SUCCESS );
-                  /* continue to evict */
-                }
-              else
-                {
-                  /* 무조건 첫 노드만 에이징한다.
-                   * node가 free되었으므로, 이 노드를 액세스하는 것은,
-                   * 쓰레기 값을 읽는 것이다. 다른 트랜잭션이 동일 주소의 노드를
-                   * 할당받아 다른 값을 기록할 수도 있다. 따라서 free된 노드의 next를
-                   * 참조하면 꼬이는 수가 있다. */
-                  goto label_try_again;
-                }
-            }
+      /* a reader is still on it: pass it over in this revolution rather */
+      /* than waiting for the reader (the hand's own slots do not count) */
+      if( data_list_node_has_readers( node ) == true )
+        {
+          (void)atomic_cas_32( &(node->state), DLIST_NODE_STATE_NEED_EVICT, state );
+          return false;
+        }
 
-#ifdef DEBUG
-          printf(" - evict node - key:%d\n", node->key );
-#endif /* DEBUG */
+      return true;
+    }
 
-          /* EVICT를 수행하는 블럭! */
-            {
-              /* node->state == DLIST_NODE_STATE_NEED_EVICT */
-              while( true )
-                {
-                  cur_node_next = cursor->cur_node->next;
+  /* invalidated in an earlier revolution already */
+  return ( data_list_node_has_readers( node ) == true ) ? false : true;
+}
 
-                  if( t->data_list_count < THRESHOLD_WORKING_SLOW_EVICTOR )
-                    {
-                      thread_sleep( 0, THRESHOLD_WORKING_SLOW_EVICTOR * 10 );
-                    }
+int32_t data_list_evict( data_table_t * t )
+{
+  data_list_node_t  * node = NULL;
+  data_list_node_t  * run[EVICT_RUN_MAX];
+  int32_t  run_cnt = 0;
+  int32_t  evict_cnt = 0;
 
-                  if( DL_STATUS_OK == lf_dlist_delete( cursor->l, cursor->cur_node ) )
-                    {
-                      /* IMPORTANT:
-                       * 아래 함수 호출 이전까지 아래와 같은 상황이다.
-                       * node1    <-------------------  node2
-                       *   |  \-----d---|                 ^
-                       *   ---------->  delnode -----d----|
-                       *
-                       *   따라서 아래함수를 호출하여 
-                       * node1  <----------------->   node2
-                       *     ^                          ^
-                       *     ----d---- delnode ----d----|
-                       *  와 같은 생태로 만들어 준다*/
-                      for( tmp = cur_node_next; tmp != cursor->l->head ; )
-                        {
-                          tmp = lf_dlist_get_prev( cursor->l, tmp );
-                        }
-
-                      /* 트랜잭션 유입이 있다면 evictor가 동작할 것이다.
-                       * 이때, list에 리스트 노드가 적을 수록, 
-                       * insert 스레드와 evictor가 서로 충돌하여 역전될 확률이 높아진다. 
-                       * 이를 방지하기 위해 데이터 리스트의 개수가 적고, 수행되는
-                       * 트랜잭션이 있다면, evictor가 느리게 동작해야 한다. */
-                      if( t->data_list_count <= THRESHOLD_WORKING_SLOW_EVICTOR ) /* && insert threads are doing some operations. */
-                        {
-                          lf_dlist_backoff( t->aging_list );
-                          lf_dlist_backoff( t->aging_list );
-                          lf_dlist_backoff( t->aging_list );
-                          lf_dlist_backoff( t->aging_list );
-                          // thread_sleep( 0 , 1 );
-                        }
-
-                      break;
-                    }
-                }
+  /* run[] 의 노드들은 hand 의 hazard pointer 로 보호되지 않는다 */
+  lf_dlist_epoch_enter();
 
-              while( true )
-                {
-                  if( data_list_node_is_read_latched( node ) != true )
-                    {
-                      break;
-                    }
+  mem_barrier();
+  while( g_exit_flag == false && data_list_count( t ) > 0 )
+    {
+      /* 정책(t.evictor)이 고른 다음 희생 노드. hand 는 호출 사이에도
+       * 제자리에 있으므로 매번 head 부터 다시 훑지 않는다. */
+      node = (data_list_node_t *)evictor_next( t->evictor, EVICT_HAND_BUDGET );
+      if( node == NULL )
+        {
+          break;
+        }
 
-                  lf_dlist_backoff( t->aging_list );
-                }
+#ifdef DEBUG
+      printf(" - evict node - key:%d\n", node->key );
+#endif /* DEBUG */
 
-              /* NOTE:
-               * 이후에 이 삭제할 노드로 들어올 수 있는 링크는 없어야 한다.
-               * 만일, tb_f_malloc()  함수에서 DL_NODE_DELETED 비트로 새겨진
-               * 링크를 액세스하다가 죽는 문제가 발생하면, backoff 시간이
-               * 짧아서 생기는 문제다. */
-              mem_barrier();
+      /* 키가 연속이 아니면 그 사이에 다른 노드가 있거나 insert 가 들어올
+       * 수 있다. delete_range 는 first~last 사이의 노드를 모두 떼어내므로
+       * 연속된 키까지만 run 으로 묶는다. */
+      if( run_cnt > 0 &&
+          ( run_cnt == EVICT_RUN_MAX || node->key != run[run_cnt - 1]->key + 1 ) )
+        {
+          TRY( data_list_evict_run( t, run, run_cnt ) != RC_SUCCESS );
+          evict_cnt += run_cnt;
+          run_cnt = 0;
+        }
 
-              while( true )
-                {
-                  DL_STATUS st = DL_STATUS_OK;
+      run[run_cnt++] = node;
+    }
 
-                  if( t->data_list_count < 3 ) /* && insert threads are doing some operations. */
-                    {
-                      lf_dlist_backoff( t->aging_list );
-                      lf_dlist_backoff( t->aging_list );
-                    }
+  if( run_cnt > 0 )
+    {
+      TRY( data_list_evict_run( t, run, run_cnt ) != RC_SUCCESS );
+      evict_cnt += run_cnt;
+    }
 
-                  st = lf_dlist_insert_before( t->aging_list, 
-                                               (dlist_node_t *)(t->aging_list->tail), 
-                                               dlist_cursor_conv_lnode_to_anode( cursor ) );
-                  if( st == DL_STATUS_OK )
-                    {
-                      do {
-                        ret = data_list_node_set_state( node, DLIST_NODE_STATE_EVICTED );
-                      } while( ret != RC_SUCCESS );
+  lf_dlist_epoch_exit();
 
-                      atomic_dec_fetch( &(t->data_list_count) );
-                      atomic_inc_fetch( &(t->aging_list_count) );
-                      break;
-                    }
-                  else
-                    {
-                      /* ager와 충돌이 났을 것이다. 
-                       * 백오프하여 삽입 시점을 조정한다 */
-                      lf_dlist_backoff( t->aging_list );
-                      lf_dlist_backoff( t->aging_list );
-                      thread_sleep( 0 , 1 );
-                    }
-                }
+  return evict_cnt;
 
-              evict_cnt++;
+  CATCH_END;
 
-#if 1 // IMPRV_SAFETY
-              /* 무조건 첫 노드만 에이징한다. 
-               * node가 free되었으므로, 이 노드를 액세스하는 것은, 
-               * 쓰레기 값을 읽는 것이다. 다른 트랜잭션이 동일 주소의 노드를
-               * 할당받아 다른 값을 기록할 수도 있다. 따라서 free된 노드의 next를
-               * 참조하면 꼬이는 수가 있다. */
-              // goto label_try_again;
-              break;
-#endif // IMPRV_SAFETY
-            } /* if node->status */
-        } /* DLIST_ITERATE */
-    }
+  lf_dlist_epoch_exit();
 
-  is_cursor_open = false;
-  dlist_cursor_close( cursor );
+  return RC_FAIL;
+}
 
-  return evict_cnt;
+/* move [run] (consecutive keys, NEED_EVICT) from t.list to the aging list */
+int32_t data_list_evict_run( data_table_t      * t,
+                             data_list_node_t ** run,
+                             int32_t             run_cnt )
+{
+  int32_t  ret = 0;
+  int32_t  i = 0;
+  DL_STATUS st = DL_STATUS_OK;
+
+  /* 트랜잭션 유입이 있다면 evictor가 동작할 것이다.
+   * 이때, list에 리스트 노드가 적을 수록, 
+   * insert 스레드와 evictor가 서로 충돌하여 역전될 확률이 높아진다. 
+   * 이를 방지하기 위해 데이터 리스트의 개수가 적고, 수행되는
+   * 트랜잭션이 있다면, evictor가 느리게 동작해야 한다. */
+  if( data_list_count( t ) < THRESHOLD_WORKING_SLOW_EVICTOR )
+    {
+      thread_sleep( 0, THRESHOLD_WORKING_SLOW_EVICTOR * 10 );
+    }
 
-  CATCH_END;
+  /* run 전체를 data list 에서 떼어내 ag_prev/ag_next 로 aging list 의
+   * tail 앞에 한번에 붙인다. evictor는 하나뿐이고, 다른 스레드는 data
+   * list의 노드를 삭제하지 않으므로 항상 DL_STATUS_OK 다.
+   * 리더가 아직 노드를 읽고 있어도 된다: 노드는 ager 가 retire 한 뒤
+   * 모든 리더가 커서를 닫거나 reset 해야 해제된다. */
+  st = lf_dlist_transfer_range( t->list,
+                                lf_dlist_relaxed_tail( t->aging ),
+                                (dlist_node_t *)run[0],
+                                (dlist_node_t *)run[run_cnt - 1],
+                                offsetof(data_list_node_t, ag_prev) );
+  TRY( st != DL_STATUS_OK );
+
+  mem_barrier();
 
-  if( is_cursor_open == true )
+  for( i = 0 ; i < run_cnt ; i++ )
     {
-      dlist_cursor_close( cursor );
+      do {
+        ret = data_list_node_set_state( run[i], DLIST_NODE_STATE_EVICTED );
+      } while( ret != RC_SUCCESS );
     }
 
+  return RC_SUCCESS;
+
+  CATCH_END;
+
   return RC_FAIL;
 }
 
@@ -1290,181 +1787,175 @@ uint64_t data_list_get_total_aging_cnt( void )
   return g_total_aged_node_cnt;
 }
 
-int32_t data_list_delete_evicted( volatile data_table_t * t )
+static void data_list_sweep_check( dlist_node_t * node, void * ctx )
+{
+  data_list_node_t * lnode = (data_list_node_t *)node;
+
+  (void)ctx;
+
+  if( lnode->key < 0 || lnode->key >= MAX_ITEM_CNT ||
+      lnode->state < DLIST_NODE_STATE_INIT || lnode->state >= DLIST_NODE_STATE_MAX )
+    {
+      atomic_inc_fetch( &g_sweep_bad_cnt );
+    }
+}
+
+/* Check every node of t.list with g_sweep_threads threads; returns the
+ * number of nodes checked */
+int64_t data_list_sweep( data_table_t * t )
 {
-  volatile data_list_node_t  * node = NULL;
-  volatile dlist_cursor_t     cursor[1] = {};
-  volatile dlist_node_t     * tmp = NULL;
-  volatile dlist_node_t     * cur_node_next = NULL;
-  volatile bool       is_cursor_open = false;
-  volatile uint32_t   aging_cnt = 0;
-  int32_t     ret = 0;
+  atomic_inc_fetch( &g_sweep_cnt );
+
+  return lf_dlist_parallel_for( t->list,
+                                (uint32_t)g_sweep_threads,
+                                data_list_sweep_check,
+                                NULL );
+}
+
+int32_t data_list_delete_evicted( data_table_t * t )
+{
+  data_list_node_t  * node = NULL;
+  dlist_cursor_t      cursor[1] = {};
+  dlist_node_t      * first = NULL;
+  dlist_node_t      * last = NULL;
+  dlist_node_t      * anode = NULL;
+  dlist_node_t      * anext = NULL;
+  lf_dlist_t        * aging = NULL;
+  uint32_t    aging_cnt = 0;
+  int32_t     take_cnt = 0;
   int32_t     print_unit = (int)(MAX_ITEM_CNT/1000);
+  DL_STATUS   st = DL_STATUS_OK;
 
   if( print_unit == 0 )
     {
        print_unit = 100;
     }
 
-  (void)dlist_cursor_open( cursor, t->aging_list, DL_CURSOR_DIR_FORWARD );
-  is_cursor_open = true;
+  /* 데이터가 남아 있으면 aging list 가 어느 정도 찰 때까지 기다린다 */
+  if( data_list_count( t ) > 0 && aging_list_count( t ) < THRESHOLD_WORKING_SLOW_AGER )
+    {
+      return 0;
+    }
 
-label_aging_again:
-  mem_barrier();
-  if( t->aging_list_count > 0 )
+  /* lane 을 하나씩 돌아가며 비운다. 순서는 lane 안에서만 FIFO 다.
+   * 한 번에 AGING_TAKE_MAX 개까지 떼어내므로 전체 순서는
+   * (lane 수 - 1) * AGING_TAKE_MAX 자리까지 어긋날 수 있다. */
+  aging = lf_dlist_relaxed_front( t->aging );
+  if( aging == NULL )
     {
-      (void)dlist_cursor_reset( cursor );
+      return 0;
+    }
 
-      DLIST_ITERATE( cursor )
+  /* aging list 의 앞에서부터 EVICTED 상태인 노드의 수를 센다. */
+  TRY( dlist_cursor_open( cursor, aging, DL_CURSOR_DIR_FORWARD ) != RC_SUCCESS );
+  DLIST_ITERATE( cursor )
+    {
+      if( g_exit_flag == true )
         {
-          if( g_exit_flag == true )
-            {
-              break;
-            }
-
-          if( t->data_list_count > 0 &&  t->aging_list_count < THRESHOLD_WORKING_SLOW_AGER )
-            {
-              break;
-            }
-
-          node = dlist_cursor_conv_anode_to_lnode( cursor );
-          mem_barrier();
-          TRY_GOTO( node->state < DLIST_NODE_STATE_EVICTED, label_aging_again ); 
-
-          /* 아래 코드는 multi-ager를 염두해둔 코드다.
-           * 2개이상의 ager가 동작할 때는 이 코드가 유용할 것. 
-           * 즉, 현재 노드는 다른 에이징 스레드가 aging 하는 중이니 다음 노드를
-           * 시도한다. */
-          ret = data_list_node_set_state( node, DLIST_NODE_STATE_ON_AGING );
-          if( ret != RC_SUCCESS )
-            {
-              continue;
-            }
-
-          while( true )
-            {
-              if( data_list_node_is_read_latched( node ) != true )
-                {
-                  break;
-                }
-            }
+          break;
+        }
 
-          while( true )
-            {
-              cur_node_next = cursor->cur_node->next;
+      node = dlist_cursor_conv_anode_to_lnode( cursor );
+      mem_barrier();
+      if( node->state < DLIST_NODE_STATE_EVICTED )
+        {
+          /* evictor가 아직 상태를 바꾸지 않았다. prefix 는 여기까지. */
+          break;
+        }
 
-              /* 데이터 삽입이 있다면 evictor가 동작할 것인데, 
-               * aging list에 대한 충돌확률이 높아진다. 이때는 ager가 살짝 쉬어준다. */
-              if( (t->aging_list_count <= THRESHOLD_WORKING_SLOW_AGER ) &&
-                  (t->data_list_count == 1) )
-                {
-                  lf_dlist_backoff( t->aging_list );
-                  lf_dlist_backoff( t->aging_list );
-                  lf_dlist_backoff( t->aging_list );
-                }
+      /* 아래 코드는 multi-ager를 염두해둔 코드다.
+       * 2개이상의 ager가 동작할 때는 이 코드가 유용할 것. 
+       * 즉, 현재 노드는 다른 에이징 스레드가 aging 하는 중이니
+       * prefix 를 여기서 끊는다. */
+      if( data_list_node_set_state( node, DLIST_NODE_STATE_ON_AGING ) != RC_SUCCESS )
+        {
+          break;
+        }
 
+      if( ++take_cnt == AGING_TAKE_MAX )
+        {
+          break;
+        }
+    }
+  dlist_cursor_close( cursor );
 
-              if( DL_STATUS_OK == lf_dlist_delete( cursor->l, cursor->cur_node ) )
-                {
-                  /* IMPORTANT:
-                   * 아래 함수 호출 이전까지 아래와 같은 상황이다.
-                   * node1    <-------------------  node2
-                   *     |<-----d---|                 ^
-                   *     -------->  delnode -----d----|
-                   *
-                   *   따라서 아래함수를 호출하여 
-                   * node1  <----------------->   node2
-                   *     ^                          ^
-                   *     ----d---- delnode ----d----|
-                   *  와 같은 생태로 만들어 준다*/
-                  for( tmp = cur_node_next; tmp != cursor->l->head ; )
-                    {
-                      tmp = lf_dlist_get_prev( cursor->l, tmp );
-                    }
-                  break;
+  if( take_cnt == 0 )
+    {
+      return 0;
+    }
 
-                  if( (t->aging_list_count <= THRESHOLD_WORKING_SLOW_AGER ) &&
-                      (t->data_list_count == 1) )
-                    {
-                      lf_dlist_backoff( t->aging_list );
-                      lf_dlist_backoff( t->aging_list );
-                      lf_dlist_backoff( t->aging_list );
-                    }
-                }
-            }
+  /* 데이터 삽입이 있다면 evictor가 동작할 것인데, 
+   * aging list에 대한 충돌확률이 높아진다. 이때는 ager가 살짝 쉬어준다. */
+  if( (aging_list_count( t ) <= THRESHOLD_WORKING_SLOW_AGER ) &&
+      (data_list_count( t ) == 1) )
+    {
+      lf_dlist_backoff( aging );
+      lf_dlist_backoff( aging );
+      lf_dlist_backoff( aging );
+    }
 
-          /* wait for resolving conflictions */
-          mem_barrier();
+  /* prefix 를 head->next 한번의 CAS 로 떼어낸다. aging list 의 노드를
+   * 지우는 것은 ager 뿐이고 evictor 는 tail 쪽에만 붙이므로, 방금 센
+   * 노드들이 그대로 prefix 다. */
+  st = lf_dlist_take_prefix( aging, take_cnt, &first, &last );
+  TRY( st != DL_STATUS_OK && st != DL_STATUS_INCOMPLETE );
+  TRY( first == NULL );
 
-          /* 3. if needed, free contents */
-#if 0
-          data_ptr = node->data;
-          mem_barrier();
-          if( data_ptr != NULL )
-            {
-              free( data_ptr );
-              node->data = NULL;
-            }
-#endif
+  for( anode = first ; ; anode = anext )
+    {
+      anext = lf_dlist_dereference_node_pointer_mem_only( anode->next );
+      node  = aging_list_n_to_data_list_n( anode );
+      TRY( node->state != DLIST_NODE_STATE_ON_AGING );
 
-          /* 4. free table entry */
-          free( node );
-          node = NULL;
+      /* 리더나 다른 커서가 아직 노드를 보고 있을 수 있으므로 바로 free 하지
+       * 않는다. grace period 가 지나면 data list 의 allocator 로 반환된다. */
+      TRY( lf_dlist_retire_node( t->list, (void *)node ) != RC_SUCCESS );
 
-          atomic_dec_fetch( &(t->aging_list_count) );
-          atomic_inc_fetch( &g_total_aged_node_cnt );
+      atomic_inc_fetch( &g_total_aged_node_cnt );
 
-          aging_cnt++;
+      aging_cnt++;
 
 #ifdef DEBUG
-          printf("[total aging #:%d][data list #:%d][aging list #:%d]\n",
-                 g_total_aged_node_cnt,
-                 t->data_list_count,
-                 t->aging_list_count );
+      printf("[total aging #:%d][data list #:%d][aging list #:%d]\n",
+             g_total_aged_node_cnt,
+             data_list_count( t ),
+             aging_list_count( t ) );
 #else
-          // print trace log 10 times
-          if( g_is_verbose_short == true )
-            {
-              if( g_total_aged_node_cnt % print_unit == 0 ) {
-                printf("[total aging #:%d][data list #:%d][aging list #:%d]\n",
-                       g_total_aged_node_cnt,
-                       t->data_list_count,
-                       t->aging_list_count );
-                fflush(stdout);
-              }
-            }
+      // print trace log 10 times
+      if( g_is_verbose_short == true )
+        {
+          if( g_total_aged_node_cnt % print_unit == 0 ) {
+            printf("[total aging #:%d][data list #:%d][aging list #:%d]\n",
+                   g_total_aged_node_cnt,
+                   data_list_count( t ),
+                   aging_list_count( t ) );
+            fflush(stdout);
+          }
+        }
 #endif /* DEBUG */
 
-#if 1 // IMPRV_SAFETY
-          /* 무조건 한 노드만 aging 한다.
-           * node가 free되었으므로, 이 노드를 액세스하는 것은, 
-           * 쓰레기 값을 읽는 것이다. 다른 트랜잭션이 동일 주소의 노드를
-           * 할당받아 다른 값을 기록할 수도 있다. 따라서 free된 노드의 next를
-           * 참조하면 꼬이는 수가 있다. */
-          goto label_aging_again;
-#endif
+      if( anode == last )
+        {
+          break;
         }
     }
 
-  is_cursor_open = false;
-  dlist_cursor_close( cursor );
-
   return aging_cnt;
 
   CATCH_END;
 
-  if( is_cursor_open == true )
-    {
-      dlist_cursor_close( cursor );
-    }
-
   return RC_FAIL;
 }
 
 void sig_dump_list( int sig )
 {
+  int32_t i = 0;
+
   dump_list( g_tbl->list );
-  dump_list( g_tbl->aging_list );
+  for( i = 0 ; i < g_aging_lanes ; i++ )
+    {
+      dump_list( lf_dlist_relaxed_lane( g_tbl->aging, i ) );
+    }
   return;
 }
 
@@ -1536,4 +2027,761 @@ int32_t working_threads_join( thr_arg_t * volatile targs, int32_t thr_cnt )
   return RC_SUCCESS;
 }
 
+/* Harness of the deque and striped modes: THR_NUM_INSERT threads run
+ * [insert_fn] and THR_NUM_READ threads [read_fn], all started together on
+ * g_thr_barrier; [elapsed] is the time from the start to the last join, in
+ * seconds. The modes allocate their nodes up front and free them after
+ * this returns, so a node taken out of a list is never freed while another
+ * thread still reads it. */
+int32_t working_threads_run( thread_func_t insert_fn,
+                             thread_func_t read_fn,
+                             double      * elapsed )
+{
+  thr_arg_t      * targs = NULL;
+  int32_t          thr_cnt = THR_NUM_INSERT + THR_NUM_READ;
+  int32_t          i = 0;
+  struct timespec  begin_ts;
+  struct timespec  end_ts;
+
+  targs = (thr_arg_t *)calloc( thr_cnt, sizeof(thr_arg_t) );
+  TRY( targs == NULL );
+
+  TRY_GOTO( pthread_barrier_init( g_thr_barrier, NULL, thr_cnt + 1 ) != 0,
+            err_fail_create_thread );
+
+  for( i = 0 ; i < thr_cnt ; i++ )
+    {
+      targs[i].tid  = i;
+      targs[i].func = (i < THR_NUM_INSERT) ? insert_fn : read_fn;
+      TRY_GOTO( pthread_create( &(targs[i].thr), NULL, targs[i].func, &targs[i] ) != 0,
+                err_fail_create_thread );
+    }
+
+  pthread_barrier_wait( g_thr_barrier );
+  clock_gettime( CLOCK_MONOTONIC, &begin_ts );
+
+  (void)working_threads_join( targs, thr_cnt );
+
+  clock_gettime( CLOCK_MONOTONIC, &end_ts );
+  *elapsed = (double)(end_ts.tv_sec - begin_ts.tv_sec) +
+    (double)(end_ts.tv_nsec - begin_ts.tv_nsec) / 1e9;
+
+  free( targs );
+
+  return RC_SUCCESS;
+
+  CATCH( err_fail_create_thread )
+    {
+      /* the started threads wait on the barrier for good */
+      fprintf( stderr, "can not create threads \n" );
+      exit( 1 );
+    }
+  CATCH_END;
+
+  return RC_FAIL;
+}
+
+
+
+/*******************************************************
+ * deque mode (--deque)
+ *
+ *   insert threads: push nodes 0 ~ item-count - 1
+ *   read threads:   pop until item-count nodes are popped
+ *
+ *   fifo:  push_back  -> pop_front
+ *   lifo:  push_back  -> pop_back
+ *   mixed: push_front/push_back -> pop_front/pop_back (alternately)
+ *   lru:   insert_before(tail) with a hash index -> the read threads look
+ *          up random keys and move the node to the tail (1 in 8 to the
+ *          head) or delete it (1 in 16); once every node is inserted they
+ *          also evict with pop_front, until the list is empty. The first
+ *          DEQUE_LRU_PINNED keys are never deleted: until the evictions
+ *          start, the first read thread walks the list now and then, and
+ *          each of them that is inserted must be met by one walk out of
+ *          DEQUE_LRU_MISSES in a row at least
+ ********************************************************/
+static const char * g_deque_mode_name[DEQUE_MODE_MAX] =
+{
+  "none",
+  "fifo",
+  "lifo",
+  "mixed",
+  "lru"
+};
+
+deque_mode_t deque_mode_parse( const char * name )
+{
+  int32_t i = 0;
+
+  for( i = DEQUE_MODE_FIFO ; i < DEQUE_MODE_MAX ; i++ )
+    {
+      if( strcmp( name, g_deque_mode_name[i] ) == 0 )
+        {
+          return (deque_mode_t)i;
+        }
+    }
+
+  return DEQUE_MODE_MAX;
+}
+
+void * func_deque_push( void * arg )
+{
+  char         esb[64];
+  thr_arg_t  * targ = (thr_arg_t *)arg;
+  int32_t      idx  = 0;
+
+  pthread_barrier_wait( g_thr_barrier );
+  TRY_GOTO( errno != 0, err_wait_barrier );
+
+  while( true )
+    {
+      idx = atomic_inc_fetch( &g_next_key );
+      if( idx >= MAX_ITEM_CNT )
+        {
+          break;
+        }
+
+      if( g_deque_mode == DEQUE_MODE_MIXED && (idx & 1) )
+        {
+          (void)lf_dlist_push_front( g_deque, (dlist_node_t *)&g_deque_nodes[idx] );
+        }
+      else if( g_deque_combine == true )
+        {
+          /* indexes like insert_before */
+          (void)lf_dlist_fc_append( g_deque,
+                                    (dlist_node_t *)&g_deque_nodes[idx],
+                                    (dlist_node_t *)&g_deque_nodes[idx] );
+        }
+      else if( g_deque_mode == DEQUE_MODE_LRU )
+        {
+          /* push_* does not index */
+          (void)lf_dlist_insert_before( g_deque,
+                                        g_deque_tail,
+                                        (dlist_node_t *)&g_deque_nodes[idx] );
+        }
+      else
+        {
+          (void)lf_dlist_push_back( g_deque, (dlist_node_t *)&g_deque_nodes[idx] );
+        }
+
+      if( g_deque_mode == DEQUE_MODE_LRU )
+        {
+          g_deque_nodes[idx].inserted = 1;
+          atomic_inc_fetch( &g_deque_pushed );
+        }
+    }
+
+  return NULL;
+
+  CATCH( err_wait_barrier )
+    {
+      perror(get_thr_error_prefix(targ->tid, esb));
+    }
+  CATCH_END;
+
+  return NULL;
+}
+
+void * func_deque_pop( void * arg )
+{
+  char            esb[64];
+  thr_arg_t     * targ = (thr_arg_t *)arg;
+  dlist_node_t  * node = NULL;
+  deque_node_t  * dnode = NULL;
+  DL_STATUS       st   = DL_STATUS_OK;
+  uint32_t        i    = 0;
 
+  pthread_barrier_wait( g_thr_barrier );
+  TRY_GOTO( errno != 0, err_wait_barrier );
+
+  while( g_delete_cnt < MAX_ITEM_CNT )
+    {
+      if( g_deque_mode == DEQUE_MODE_FIFO ||
+          (g_deque_mode == DEQUE_MODE_MIXED && (i++ & 1)) )
+        {
+          st = lf_dlist_pop_front( g_deque, &node );
+        }
+      else
+        {
+          st = lf_dlist_pop_back( g_deque, &node );
+        }
+
+      if( st == DL_STATUS_NOT_FOUND )
+        {
+          /* empty: wait for the pushers */
+          cpu_relax();
+          continue;
+        }
+
+      dnode = (deque_node_t *)node;
+      TRY_GOTO( atomic_inc_fetch( &(dnode->pop_cnt) ) != 1, err_popped_twice );
+
+      atomic_inc_fetch( &g_delete_cnt );
+    }
+
+  return NULL;
+
+  CATCH( err_wait_barrier )
+    {
+      perror(get_thr_error_prefix(targ->tid, esb));
+    }
+  CATCH( err_popped_twice )
+    {
+      fprintf( stderr, "%s node[%d] popped twice\n",
+               get_thr_error_prefix(targ->tid, esb),
+               dnode->key );
+      abort();
+    }
+  CATCH_END;
+
+  return NULL;
+}
+
+static int64_t deque_node_key( dlist_node_t * node )
+{
+  return ((deque_node_t *)node)->key;
+}
+
+/* lru: walk the list and count the walks in a row that missed each */
+/* inserted pinned node in [misses]; false if one reaches */
+/* DEQUE_LRU_MISSES. Only meaningful while nothing is popped. */
+static bool deque_lru_walk( int32_t * misses )
+{
+  dlist_node_t * node = NULL;
+  bool           inserted[DEQUE_LRU_PINNED];
+  bool           seen[DEQUE_LRU_PINNED];
+  int32_t        key = 0;
+  bool           met = true;
+
+  for( key = 0 ; key < DEQUE_LRU_PINNED ; key++ )
+    {
+      inserted[key] = ( g_deque_nodes[key].inserted != 0 ) ? true : false;
+      seen[key]     = false;
+    }
+
+  lf_dlist_epoch_enter();
+  for( node = lf_dlist_get_next( g_deque, g_deque_head ) ;
+       node != NULL && node != g_deque_tail ;
+       node = lf_dlist_get_next( g_deque, node ) )
+    {
+      key = ((deque_node_t *)node)->key;
+      if( key < DEQUE_LRU_PINNED )
+        {
+          seen[key] = true;
+        }
+    }
+  lf_dlist_epoch_exit();
+
+  for( key = 0 ; key < DEQUE_LRU_PINNED ; key++ )
+    {
+      misses[key] = ( inserted[key] == true && seen[key] == false ) ? misses[key] + 1 : 0;
+      if( misses[key] >= DEQUE_LRU_MISSES )
+        {
+          met = false;
+        }
+    }
+
+  return met;
+}
+
+void * func_deque_lru( void * arg )
+{
+  char            esb[64];
+  thr_arg_t     * targ = (thr_arg_t *)arg;
+  dlist_node_t  * node = NULL;
+  deque_node_t  * dnode = NULL;
+  DL_STATUS       st   = DL_STATUS_OK;
+  uint32_t        seed = (uint32_t)targ->tid;
+  uint32_t        op   = 0;
+  uint32_t        ops  = 0;
+  int32_t         key  = 0;
+  bool            walk = ( targ->tid == THR_NUM_INSERT ) ? true : false;
+  int32_t         misses[DEQUE_LRU_PINNED] = { 0 };
+
+  pthread_barrier_wait( g_thr_barrier );
+  TRY_GOTO( errno != 0, err_wait_barrier );
+
+  /* the nodes are freed after the join: no epoch or hazard pointer needed */
+  /* to keep a found node readable until it is moved */
+  while( g_deque_pushed < MAX_ITEM_CNT || lf_dlist_size( g_deque ) > 0 )
+    {
+      /* the evictions may start during the walk: only misses seen before */
+      /* them count */
+      if( walk == true && ++ops % DEQUE_LRU_WALK == 0 && g_deque_pushed < MAX_ITEM_CNT )
+        {
+          TRY_GOTO( deque_lru_walk( misses ) == false && g_deque_pushed < MAX_ITEM_CNT, err_lost );
+        }
+
+      op   = (uint32_t)rand_r( &seed );
+      key  = (int32_t)(op % (uint32_t)MAX_ITEM_CNT);
+      node = lf_dlist_find( g_deque, key );
+      op   = (uint32_t)rand_r( &seed );
+
+      if( node != NULL )
+        {
+          if( op % 16 == 0 && key >= DEQUE_LRU_PINNED )
+            {
+              st = lf_dlist_delete( g_deque, node );
+              TRY_GOTO( st != DL_STATUS_OK && st != DL_STATUS_NOT_FOUND, err_move );
+            }
+          else
+            {
+              st = ( op % 8 == 1 ) ? lf_dlist_move_to_head( g_deque, node )
+                                   : lf_dlist_move_to_tail( g_deque, node );
+              TRY_GOTO( st != DL_STATUS_OK && st != DL_STATUS_NOT_FOUND, err_move );
+              if( st == DL_STATUS_OK )
+                {
+                  atomic_inc_fetch( &g_deque_move_cnt );
+                }
+            }
+        }
+
+      if( g_deque_pushed >= MAX_ITEM_CNT && (op & 1) &&
+          lf_dlist_pop_front( g_deque, &node ) == DL_STATUS_OK )
+        {
+          dnode = (deque_node_t *)node;
+          TRY_GOTO( atomic_inc_fetch( &(dnode->pop_cnt) ) != 1, err_popped_twice );
+        }
+    }
+
+  return NULL;
+
+  CATCH( err_wait_barrier )
+    {
+      perror(get_thr_error_prefix(targ->tid, esb));
+    }
+  CATCH( err_move )
+    {
+      fprintf( stderr, "%s move or delete failed: %d\n",
+               get_thr_error_prefix(targ->tid, esb),
+               st );
+      abort();
+    }
+  CATCH( err_lost )
+    {
+      fprintf( stderr, "%s a pinned node was not met by %d walks in a row\n",
+               get_thr_error_prefix(targ->tid, esb),
+               DEQUE_LRU_MISSES );
+      abort();
+    }
+  CATCH( err_popped_twice )
+    {
+      fprintf( stderr, "%s node[%d] popped twice\n",
+               get_thr_error_prefix(targ->tid, esb),
+               dnode->key );
+      abort();
+    }
+  CATCH_END;
+
+  return NULL;
+}
+
+int32_t deque_run( void )
+{
+  char             esb[512];
+  dlist_node_t   * node  = NULL;
+  int32_t          i = 0;
+  double           elapsed = 0.0;
+
+  lf_dlist_initiaize( g_deque,
+                      g_deque_head,
+                      g_deque_tail,
+                      g_backoff_policy,
+                      DLIST_DEFAULT_MAX_BACKOFF_LIST );
+
+  g_deque_nodes = (deque_node_t *)calloc( MAX_ITEM_CNT, sizeof(deque_node_t) );
+  TRY_GOTO( g_deque_nodes == NULL, err_fail_alloc );
+
+  for( i = 0 ; i < MAX_ITEM_CNT ; i++ )
+    {
+      g_deque_nodes[i].key = i;
+    }
+
+  if( g_deque_mode == DEQUE_MODE_LRU )
+    {
+      lf_dlist_set_key_fn( g_deque, deque_node_key );
+      TRY_GOTO( lf_dlist_hash_create( g_deque, INDEX_HASH_BUCKETS ) != RC_SUCCESS,
+                err_fail_alloc );
+      TRY_GOTO( lf_dlist_move_create( g_deque, offsetof(deque_node_t, ref) ) != RC_SUCCESS,
+                err_fail_alloc );
+    }
+
+  if( g_deque_combine == true )
+    {
+      TRY_GOTO( lf_dlist_fc_create( g_deque ) != RC_SUCCESS, err_fail_alloc );
+      /* no failure needed to combine, never enough runs to keep on */
+      if( g_deque_combine_flip == true )
+        {
+          TRY_GOTO( lf_dlist_fc_tune( g_deque,
+                                      DEQUE_FLIP_WINDOW,
+                                      0,
+                                      LF_DLIST_FC_SLOTS + 1 ) != RC_SUCCESS,
+                    err_fail_alloc );
+        }
+    }
+
+  TRY_GOTO( working_threads_run( func_deque_push,
+                                 (g_deque_mode == DEQUE_MODE_LRU) ? func_deque_lru
+                                                                  : func_deque_pop,
+                                 &elapsed ) != RC_SUCCESS,
+            err_fail_alloc );
+
+  /* every node is popped exactly once and the deque is empty; in the lru */
+  /* mode the ones that were not popped are deleted */
+  for( i = 0 ; i < MAX_ITEM_CNT ; i++ )
+    {
+      if( g_deque_mode == DEQUE_MODE_LRU && g_deque_nodes[i].pop_cnt == 0 )
+        {
+          node = (dlist_node_t *)&g_deque_nodes[i];
+          TRY_GOTO( i < DEQUE_LRU_PINNED ||
+                    lf_dlist_linked( g_deque, node ) == true ||
+                    lf_dlist_find( g_deque, i ) != NULL,
+                    err_bad_works_on_deque );
+          continue;
+        }
+      TRY_GOTO( g_deque_nodes[i].pop_cnt != 1, err_bad_works_on_deque );
+    }
+  TRY_GOTO( lf_dlist_size( g_deque ) != 0, err_bad_works_on_deque );
+  TRY_GOTO( lf_dlist_pop_front( g_deque, &node ) != DL_STATUS_NOT_FOUND,
+            err_bad_works_on_deque );
+  /* cas -> combining -> cas at least, with no node lost on the way */
+  TRY_GOTO( g_deque_combine_flip == true && lf_dlist_fc_switches( g_deque ) < 2,
+            err_no_tail_switch );
+
+  printf( "[atomic engine: %s][links: %s][backoff: %s][deque: %s] elapsed: %.3f sec, throughput: %.0f items/sec\n",
+          ATOMIC_ENGINE_NAME,
+          DL_LINK_MODE_NAME,
+          backoff_policy_name( g_backoff_policy ),
+          g_deque_mode_name[g_deque_mode],
+          elapsed,
+          (elapsed > 0.0) ? (double)MAX_ITEM_CNT / elapsed : 0.0 );
+  if( g_deque_mode == DEQUE_MODE_LRU )
+    {
+      printf( "[lru] promotions: %d (moved or coalesced)\n", g_deque_move_cnt );
+    }
+  if( g_deque_combine == true )
+    {
+      printf( "[tail] %s at the end, %llu mode switches\n",
+              ( lf_dlist_fc_combining( g_deque ) == true ) ? "combining" : "cas",
+              (unsigned long long)lf_dlist_fc_switches( g_deque ) );
+    }
+
+  /* the hash index retires its entries, the moves their proxies */
+  lf_dlist_epoch_barrier();
+  free( g_deque_nodes );
+  g_deque_nodes = NULL;
+  lf_dlist_finalize( g_deque );
+
+  return RC_SUCCESS;
+
+  CATCH( err_fail_alloc )
+    {
+      perror(get_error_prefix(esb));
+    }
+  CATCH( err_bad_works_on_deque )
+    {
+      fprintf( stderr, "deque: node[%d] popped %d times\n",
+               (i < MAX_ITEM_CNT) ? i : -1,
+               (i < MAX_ITEM_CNT) ? g_deque_nodes[i].pop_cnt : -1 );
+      abort();
+    }
+  CATCH( err_no_tail_switch )
+    {
+      fprintf( stderr, "deque: %llu tail mode switches, expected both ways\n",
+               (unsigned long long)lf_dlist_fc_switches( g_deque ) );
+      abort();
+    }
+  CATCH_END;
+
+  if( g_deque_nodes != NULL )
+    {
+      free( g_deque_nodes );
+      g_deque_nodes = NULL;
+    }
+
+  return RC_FAIL;
+}
+
+/*******************************************************
+ * striped mode (--stripes)
+ *
+ *   insert threads: append nodes 0 ~ item-count - 1, each to the shard of
+ *                   its key (lf_dlist_striped_append())
+ *   read threads:   read thread j owns the shards j, j + r, j + 2r, ...
+ *                   and evicts from them with an evictor per shard (-e),
+ *                   until every node is evicted; the first one also scans
+ *                   all shards with a merged cursor now and then, and in
+ *                   the range mode checks that the keys keep increasing
+ *
+ * No two threads share a head or a tail unless they work on the same
+ * shard.
+ ********************************************************/
+#define STRIPED_EVICT_ROUND  64  /* victims per shard per round */
+#define STRIPED_KEEP         64  /* nodes a shard keeps while inserts go on */
+#define STRIPED_SCAN_EVERY   16  /* rounds between two merged scans */
+
+static int64_t striped_node_key( dlist_node_t * node )
+{
+  return ((striped_node_t *)node)->key;
+}
+
+void * func_striped_append( void * arg )
+{
+  char             esb[64];
+  thr_arg_t      * targ = (thr_arg_t *)arg;
+  dlist_node_t   * node = NULL;
+  int32_t          idx  = 0;
+  DL_STATUS        st   = DL_STATUS_OK;
+
+  pthread_barrier_wait( g_thr_barrier );
+  TRY_GOTO( errno != 0, err_wait_barrier );
+
+  while( true )
+    {
+      idx = atomic_inc_fetch( &g_next_key );
+      if( idx >= MAX_ITEM_CNT )
+        {
+          break;
+        }
+
+      node = (dlist_node_t *)&g_striped_nodes[idx];
+      evictor_insert( g_striped_evictors[lf_dlist_striped_shard_of( g_striped, idx )],
+                      node );
+      st = lf_dlist_striped_append( g_striped, node );
+      TRY_GOTO( st != DL_STATUS_OK, err_append );
+      atomic_inc_fetch( &g_striped_appended );
+    }
+
+  return NULL;
+
+  CATCH( err_wait_barrier )
+    {
+      perror(get_thr_error_prefix(targ->tid, esb));
+    }
+  CATCH( err_append )
+    {
+      fprintf( stderr, "%s append of node[%d] failed: %d\n",
+               get_thr_error_prefix(targ->tid, esb), idx, st );
+      abort();
+    }
+  CATCH_END;
+
+  return NULL;
+}
+
+/* one pass of a merged cursor: the keys come in increasing order as long
+ * as every shard is sorted, which the range mode guarantees */
+static int32_t striped_merged_scan( void )
+{
+  lf_dlist_striped_cursor_t mc[1];
+  dlist_node_t * node = NULL;
+  int64_t        prev = -1;
+  int64_t        key  = 0;
+
+  TRY( lf_dlist_striped_cursor_open( mc, g_striped ) != RC_SUCCESS );
+
+  for( node = lf_dlist_striped_cursor_next( mc ) ;
+       node != NULL ;
+       node = lf_dlist_striped_cursor_next( mc ) )
+    {
+      key = striped_node_key( node );
+      TRY_GOTO( g_stripe_range > 0 && key <= prev, err_out_of_order );
+      prev = key;
+    }
+
+  lf_dlist_striped_cursor_close( mc );
+  atomic_inc_fetch( &g_striped_scan_cnt );
+
+  return RC_SUCCESS;
+
+  CATCH( err_out_of_order )
+    {
+      fprintf( stderr, "striped: merged cursor returned key %ld after %ld\n",
+               (long)key, (long)prev );
+      lf_dlist_striped_cursor_close( mc );
+    }
+  CATCH_END;
+
+  return RC_FAIL;
+}
+
+void * func_striped_evict( void * arg )
+{
+  char             esb[64];
+  thr_arg_t      * targ  = (thr_arg_t *)arg;
+  int32_t          me    = targ->tid - THR_NUM_INSERT;
+  lf_dlist_t     * shard = NULL;
+  dlist_node_t   * node  = NULL;
+  striped_node_t * snode = NULL;
+  uint32_t         round = 0;
+  int32_t          done  = 0;
+  int32_t          s     = 0;
+  int32_t          i     = 0;
+
+  pthread_barrier_wait( g_thr_barrier );
+  TRY_GOTO( errno != 0, err_wait_barrier );
+
+  while( g_striped_evicted < MAX_ITEM_CNT )
+    {
+      done = 0;
+
+      for( s = me ; s < g_stripe_cnt ; s += THR_NUM_READ )
+        {
+          shard = lf_dlist_striped_shard( g_striped, (uint32_t)s );
+          if( g_striped_appended < MAX_ITEM_CNT &&
+              lf_dlist_size_approx( shard ) < STRIPED_KEEP )
+            {
+              continue;
+            }
+
+          /* shard-local: nobody else evicts from here */
+          for( i = 0 ; i < STRIPED_EVICT_ROUND ; i++ )
+            {
+              node = evictor_next( g_striped_evictors[s], EVICT_HAND_BUDGET );
+              if( node == NULL )
+                {
+                  break;
+                }
+
+              TRY_GOTO( lf_dlist_delete( shard, node ) != DL_STATUS_OK, err_evicted_twice );
+              snode = (striped_node_t *)node;
+              TRY_GOTO( atomic_inc_fetch( &(snode->evict_cnt) ) != 1, err_evicted_twice );
+              atomic_inc_fetch( &g_striped_evicted );
+              done++;
+            }
+        }
+
+      if( me == 0 && (round++ % STRIPED_SCAN_EVERY) == 0 )
+        {
+          TRY_GOTO( striped_merged_scan() != RC_SUCCESS, err_scan );
+        }
+
+      if( done == 0 )
+        {
+          thread_sleep( 0, 1 );
+        }
+    }
+
+  /* the hands hold hazard slots of this thread */
+  for( s = me ; s < g_stripe_cnt ; s += THR_NUM_READ )
+    {
+      evictor_release( g_striped_evictors[s] );
+    }
+
+  return NULL;
+
+  CATCH( err_wait_barrier )
+    {
+      perror(get_thr_error_prefix(targ->tid, esb));
+    }
+  CATCH( err_evicted_twice )
+    {
+      fprintf( stderr, "%s node[%d] evicted twice\n",
+               get_thr_error_prefix(targ->tid, esb),
+               ((striped_node_t *)node)->key );
+      abort();
+    }
+  CATCH( err_scan )
+    {
+      abort();
+    }
+  CATCH_END;
+
+  return NULL;
+}
+
+int32_t striped_run( void )
+{
+  char             esb[512];
+  int32_t          i = 0;
+  double           elapsed = 0.0;
+
+  TRY_GOTO( lf_dlist_striped_create( &g_striped,
+                                     (uint32_t)g_stripe_cnt,
+                                     g_stripe_range,
+                                     striped_node_key,
+                                     g_backoff_policy,
+                                     DLIST_DEFAULT_MAX_BACKOFF_LIST ) != RC_SUCCESS,
+            err_fail_alloc );
+
+  for( i = 0 ; i < g_stripe_cnt ; i++ )
+    {
+      TRY_GOTO( evictor_create( &g_striped_evictors[i],
+                                lf_dlist_striped_shard( g_striped, (uint32_t)i ),
+                                evict_policy_ops( g_evict_policy ),
+                                offsetof(striped_node_t, evict),
+                                NULL,
+                                NULL ) != RC_SUCCESS, err_fail_alloc );
+    }
+
+  g_striped_nodes = (striped_node_t *)calloc( MAX_ITEM_CNT, sizeof(striped_node_t) );
+  TRY_GOTO( g_striped_nodes == NULL, err_fail_alloc );
+
+  for( i = 0 ; i < MAX_ITEM_CNT ; i++ )
+    {
+      g_striped_nodes[i].key = i;
+    }
+
+  TRY_GOTO( working_threads_run( func_striped_append,
+                                 func_striped_evict,
+                                 &elapsed ) != RC_SUCCESS,
+            err_fail_alloc );
+
+  /* every node is evicted exactly once, from the shard of its key, and */
+  /* the shards are empty */
+  for( i = 0 ; i < MAX_ITEM_CNT ; i++ )
+    {
+      TRY_GOTO( g_striped_nodes[i].evict_cnt != 1, err_bad_works_on_striped );
+    }
+  TRY_GOTO( lf_dlist_striped_size( g_striped ) != 0, err_bad_works_on_striped );
+  for( i = 0 ; i < g_stripe_cnt ; i++ )
+    {
+      TRY_GOTO( evictor_resident( g_striped_evictors[i] ) != 0, err_striped_resident );
+    }
+  TRY_GOTO( striped_merged_scan() != RC_SUCCESS, err_bad_works_on_striped );
+
+  printf( "[atomic engine: %s][links: %s][backoff: %s][stripes: %d by %s][evict: %s] elapsed: %.3f sec, throughput: %.0f items/sec\n",
+          ATOMIC_ENGINE_NAME,
+          DL_LINK_MODE_NAME,
+          backoff_policy_name( g_backoff_policy ),
+          g_stripe_cnt,
+          ( g_stripe_range > 0 ) ? "range" : "hash",
+          evict_policy_name( g_evict_policy ),
+          elapsed,
+          (elapsed > 0.0) ? (double)MAX_ITEM_CNT / elapsed : 0.0 );
+  printf( "[striped] merged scans: %d\n", g_striped_scan_cnt );
+
+  for( i = 0 ; i < g_stripe_cnt ; i++ )
+    {
+      evictor_destroy( g_striped_evictors[i] );
+    }
+  lf_dlist_striped_destroy( g_striped );
+  g_striped = NULL;
+  free( g_striped_nodes );
+  g_striped_nodes = NULL;
+
+  return RC_SUCCESS;
+
+  CATCH( err_fail_alloc )
+    {
+      perror(get_error_prefix(esb));
+    }
+  CATCH( err_bad_works_on_striped )
+    {
+      fprintf( stderr, "striped: node[%d] evicted %d times, %ld nodes left\n",
+               (i < MAX_ITEM_CNT) ? i : -1,
+               (i < MAX_ITEM_CNT) ? g_striped_nodes[i].evict_cnt : -1,
+               (long)lf_dlist_striped_size( g_striped ) );
+      abort();
+    }
+  CATCH( err_striped_resident )
+    {
+      fprintf( stderr, "striped: the policy of shard[%d] still counts %ld nodes\n",
+               i, (long)evictor_resident( g_striped_evictors[i] ) );
+      abort();
+    }
+  CATCH_END;
+
+  return RC_FAIL;
+}
@@ -5,6 +5,7 @@
 
 #include <fcntl.h>
 #include <unistd.h>
+#include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
@@ -35,6 +36,77 @@
 static dlist_node_t * lf_dlist_correct_prev( lf_dlist_t   * volatile l,
                                              dlist_node_t * volatile prev,
                                              dlist_node_t * volatile node );
+static bool lf_dlist_mark_link( lf_dlist_t * volatile l, dlist_link_t * link );
+static DL_STATUS lf_dlist_mark_deleted( lf_dlist_t * volatile l, dlist_node_t * volatile node );
+static DL_STATUS lf_dlist_delete_node( lf_dlist_t * volatile l, dlist_node_t * volatile node );
+static DL_STATUS lf_dlist_unlink_range( lf_dlist_t   * volatile l,
+                                        dlist_node_t * volatile first,
+                                        dlist_node_t * volatile last,
+                                        dlist_node_t         ** end,
+                                        ptrdiff_t               hook_offset,
+                                        dlist_node_t         ** hfirst,
+                                        dlist_node_t         ** hlast );
+static void lf_dlist_index_add_chain( lf_dlist_t   * volatile l,
+                                      dlist_node_t * volatile first,
+                                      dlist_node_t * volatile last );
+static void lf_dlist_index_remove( lf_dlist_t * volatile l, dlist_node_t * volatile node );
+static DL_STATUS lf_dlist_link_chain_before( lf_dlist_t   * volatile l,
+                                             dlist_node_t * volatile pivot,
+                                             dlist_node_t * volatile first,
+                                             dlist_node_t * volatile last,
+                                             uint32_t              * fails );
+static dlist_node_t * lf_dlist_next_link( lf_dlist_t * volatile l, dlist_node_t * volatile node );
+static dlist_node_t * lf_dlist_prev_link( lf_dlist_t * volatile l, dlist_node_t * volatile node );
+static void lf_dlist_push_link_front( lf_dlist_t * volatile l, dlist_node_t * volatile node );
+static void lf_dlist_push_link_back( lf_dlist_t * volatile l, dlist_node_t * volatile node );
+static void lf_dlist_unlink_marked( lf_dlist_t   * volatile l,
+                                    dlist_node_t * volatile node,
+                                    dlist_node_t * volatile node_next );
+static dlist_node_t * lf_dlist_move_hook( lf_dlist_t * volatile l, dlist_node_t * volatile node );
+static dlist_node_t * lf_dlist_move_entry( lf_dlist_t * volatile l, dlist_node_t * volatile hook );
+static void lf_dlist_move_clear_chain( lf_dlist_t   * volatile l,
+                                       dlist_node_t * volatile first,
+                                       dlist_node_t * volatile last );
+static DL_STATUS lf_dlist_move_delete( lf_dlist_t * volatile l, dlist_node_t * volatile node );
+static DL_STATUS lf_dlist_move_pop( lf_dlist_t    * volatile l,
+                                    dlist_node_t         ** node,
+                                    bool                     front );
+
+#define lf_dlist_size_add( _l, _delta ) \
+  counter_add( (counter_t *)&((_l)->size), (_delta) )
+
+/*  Every update of a shared link goes through lf_dlist_link_cas() with the */
+/*  raw value loaded from the link as [_old], version bits included. */
+/*  In the versioned link mode the new value gets the version of [_old] */
+/*  plus one, so the CAS also fails if the link changed and changed back. */
+#ifdef DL_VERSIONED_LINKS
+#define lf_dlist_link_versioned( _old, _new )                                \
+  ((dlist_node_t *)((((((uint64_t)(_old)) >> DL_LINK_VERSION_SHIFT) + 1)     \
+                     << DL_LINK_VERSION_SHIFT) |                              \
+                    ((uint64_t)(_new) & ~DL_LINK_VERSION_MASK)))
+#else
+#define lf_dlist_link_versioned( _old, _new )  (_new)
+#endif
+
+#define lf_dlist_link_cas( _link, _old, _new ) \
+  atomic_cas_ptr( (_link), (_old), lf_dlist_link_versioned( (_old), (_new) ) )
+
+/*  Links of a node that is not published yet: keep counting its versions */
+#define lf_dlist_link_store( _link, _new ) \
+  atomic_store_rlx( (_link), lf_dlist_link_versioned( atomic_load_rlx( _link ), (_new) ) )
+
+/*  The lf_dlist_move_ref_t slot of a hook of a list with moves, see */
+/*  lf_dlist_move() */
+#define lf_dlist_move_ref( _l, _hook ) \
+  ((lf_dlist_move_ref_t *)((char *)(_hook) + (_l)->move_ref_offset))
+
+#define lf_dlist_move_proxy( _l, _hook ) \
+  ( ((uint64_t)atomic_load_acq( &(lf_dlist_move_ref( (_l), (_hook) )->holder) ) & DL_NODE_DIRTY) != 0 )
+
+/*  Where the hook of a proxy is in its pool object: the slot in front of */
+/*  it, if the slot is in front, must fit in the object as well */
+#define lf_dlist_proxy_offset( _l ) \
+  ( ((_l)->move_ref_offset < 0) ? -(_l)->move_ref_offset : 0 )
 
 #if 0
 static void lf_dlist_unmark_node_pointer( lf_dlist_t * volatile l,
@@ -48,9 +120,28 @@ void dlist_node_init( dlist_node_t * volatile node )
 {
   if( node != NULL )
     {
-      node->prev = NULL;
-      node->next = NULL;
+      atomic_store_rlx( &(node->prev), NULL );
+      atomic_store_rlx( &(node->next), NULL );
+    }
+}
+
+static void * lf_dlist_calloc( void * ctx, size_t size )
+{
+  UNUSE_ARG( ctx );
+
+  return calloc( 1, size );
+}
+
+static void * lf_dlist_pool_alloc( void * ctx, size_t size )
+{
+  node_pool_t * pool = (node_pool_t *)ctx;
+
+  if( size > node_pool_obj_size( pool ) )
+    {
+      return NULL;
     }
+
+  return node_pool_alloc( pool );
 }
 
 /* ****************************************************************************
@@ -62,6 +153,7 @@ void dlist_node_init( dlist_node_t * volatile node )
 int32_t lf_dlist_initiaize( lf_dlist_t    * volatile l,
                             dlist_node_t  * volatile head,
                             dlist_node_t  * volatile tail,
+                            backoff_policy_t backoff_policy,
                             int32_t backoff_cnt_max)
 {
   dassert( l != NULL );
@@ -70,12 +162,17 @@ int32_t lf_dlist_initiaize( lf_dlist_t    * volatile l,
 
   memset( (void *)l, 0x00, sizeof(lf_dlist_t) );
 
-  (void)RNG_init( (RNG *)(l->rng), (uint32_t)rdtsc(), 0, backoff_cnt_max );
+  l->backoff_policy = backoff_policy;
+  l->backoff_max    = (uint32_t)backoff_cnt_max;
+
+  l->alloc_fn  = lf_dlist_calloc;
+  l->free_fn   = free;
+  l->alloc_ctx = NULL;
 
   l->head = head;
-  l->head->next = tail;
+  atomic_store_rlx( &(l->head->next), tail );
   l->tail = tail;
-  l->tail->prev = head;
+  atomic_store_rlx( &(l->tail->prev), head );
 
   return RC_SUCCESS;
 }
@@ -84,6 +181,11 @@ void lf_dlist_finalize( lf_dlist_t * volatile l )
 {
   dassert( l != NULL );
 
+  lf_dlist_index_destroy( l );
+  lf_dlist_hash_destroy( l );
+  lf_dlist_seq_destroy( l );
+  lf_dlist_fc_destroy( l );
+  lf_dlist_move_destroy( l );
   memset( (void *)l, 0x00, sizeof(lf_dlist_t) );
 
 #ifdef DEBUG
@@ -93,6 +195,54 @@ void lf_dlist_finalize( lf_dlist_t * volatile l )
 #endif
 }
 
+int32_t lf_dlist_lanes_create( lf_dlist_lane_t ** _lanes,
+                               uint32_t           cnt,
+                               backoff_policy_t   backoff_policy,
+                               int32_t            backoff_cnt_max )
+{
+  lf_dlist_lane_t * lanes = NULL;
+  uint32_t          i     = 0;
+
+  TRY( _lanes == NULL || cnt == 0 );
+
+  TRY( posix_memalign( (void **)&lanes, 64, cnt * sizeof(lf_dlist_lane_t) ) != 0 );
+  memset( (void *)lanes, 0x00, cnt * sizeof(lf_dlist_lane_t) );
+
+  for( i = 0 ; i < cnt ; i++ )
+    {
+      lf_dlist_initiaize( lanes[i].list,
+                          lanes[i].head,
+                          lanes[i].tail,
+                          backoff_policy,
+                          backoff_cnt_max );
+    }
+
+  *_lanes = lanes;
+
+  return RC_SUCCESS;
+
+  CATCH_END;
+
+  return RC_FAIL;
+}
+
+void lf_dlist_lanes_destroy( lf_dlist_lane_t * lanes, uint32_t cnt )
+{
+  uint32_t i = 0;
+
+  if( lanes == NULL )
+    {
+      return;
+    }
+
+  for( i = 0 ; i < cnt ; i++ )
+    {
+      lf_dlist_finalize( lanes[i].list );
+    }
+
+  free( lanes );
+}
+
 void lf_dlist_single_thread_sanity_check( lf_dlist_t * volatile l )
 {
   dlist_node_t * volatile node = NULL;
@@ -109,25 +259,92 @@ void lf_dlist_single_thread_sanity_check( lf_dlist_t * volatile l )
   do
     {
       RAW_CHECK( node, "null dlist node" );
-      RAW_CHECK( prev->next == node, "node.prev doesn't match prev.next" );
-      RAW_CHECK( node->prev == prev, "node.prev doesn't match prev.next" );
+      RAW_CHECK( lf_dlist_link_strip( prev->next ) == node, "node.prev doesn't match prev.next" );
+      RAW_CHECK( lf_dlist_link_strip( node->prev ) == prev, "node.prev doesn't match prev.next" );
 
       prev = node;
-      node = node->next;
-    } while( node && node->next != l->tail );
+      node = lf_dlist_link_strip( node->next );
+    } while( node && lf_dlist_link_strip( node->next ) != l->tail );
 }
 
+/*  On a list with moves the hooks met on the way are resolved to the */
+/*  nodes they stand for, and the hooks that do not hold their node (a */
+/*  proxy linked for a move that lost, or the position a node was just */
+/*  moved away from) are stepped over; see lf_dlist_move(). */
 dlist_node_t * lf_dlist_get_next( lf_dlist_t * volatile l, dlist_node_t * volatile _node )
 {
-  dlist_node_t * volatile node      = _node;
-  dlist_node_t * volatile next      = NULL;
-  dlist_node_t * volatile node_next = NULL;
-  dlist_node_t * volatile next_next = NULL;
+  dlist_node_t * node  = _node;
+  dlist_node_t * entry = NULL;
+
+  if( l->move_pool == NULL )
+    {
+      return lf_dlist_next_link( l, node );
+    }
+
+  if( node != l->head && node != l->tail )
+    {
+      node = lf_dlist_move_hook( l, node );
+    }
+
+  while( true )
+    {
+      node = lf_dlist_next_link( l, node );
+      if( node == NULL || node == l->tail )
+        {
+          return node;
+        }
+
+      entry = lf_dlist_move_entry( l, node );
+      if( entry != NULL )
+        {
+          return entry;
+        }
+    }
+}
+
+dlist_node_t * lf_dlist_get_prev( lf_dlist_t * volatile l, dlist_node_t * volatile _node )
+{
+  dlist_node_t * node  = _node;
+  dlist_node_t * entry = NULL;
+
+  if( l->move_pool == NULL )
+    {
+      return lf_dlist_prev_link( l, node );
+    }
+
+  if( node != l->head && node != l->tail )
+    {
+      node = lf_dlist_move_hook( l, node );
+    }
+
+  while( true )
+    {
+      node = lf_dlist_prev_link( l, node );
+      if( node == NULL || node == l->head )
+        {
+          return node;
+        }
+
+      entry = lf_dlist_move_entry( l, node );
+      if( entry != NULL )
+        {
+          return entry;
+        }
+    }
+}
+
+/*  The next live link after [node], whatever it stands for */
+static dlist_node_t * lf_dlist_next_link( lf_dlist_t * volatile l, dlist_node_t * volatile _node )
+{
+  dlist_node_t * node      = _node;
+  dlist_node_t * next      = NULL;
+  dlist_node_t * node_next = NULL;
+  dlist_node_t * next_next = NULL;
 
   while( node != l->tail )
     {
       RAW_CHECK( node, "null current node" );
-      next = lf_dlist_dereference_node_pointer_mem_only( node->next );
+      next = lf_dlist_dereference_node_pointer_mem_only( atomic_load_acq( &(node->next) ) );
       if( next == NULL )
         {
           return NULL;
@@ -135,27 +352,24 @@ dlist_node_t * lf_dlist_get_next( lf_dlist_t * volatile l, dlist_node_t * volati
 
       // RAW_CHECK( next, "null next pointer in list" );
 
-      mem_barrier();
-      next_next = next->next;
+      next_next = atomic_load_acq( &(next->next) );
 
       if( (uint64_t)next_next & DL_NODE_DELETED )
         {
           /*  The next pointer of the node behind me has the deleted mark set */
-          node_next = node->next;
+          node_next = atomic_load_acq( &(node->next) );
 
-          mem_barrier();
-
-          if( (uint64_t)node_next != ((uint64_t)next | DL_NODE_DELETED) )
+          if( (uint64_t)lf_dlist_link_strip( node_next ) != ((uint64_t)next | DL_NODE_DELETED) )
             {
               /*  But my next pointer isn't pointing the next with the deleted bit set, */
               /*  so we set the deleted bit in next's prev pointer. */
 #if 0 // IMPRV_SAFETY
-              lf_dlist_mark_node_pointer( l, (dlist_node_t ** volatile)&(next->prev) );
+              lf_dlist_mark_node_pointer( l, &(next->prev) );
 
               /*  Now try to unlink the deleted next node */
-              (void)atomic_cas_64( &(node->next),
-                                   next,
-                                   (dlist_node_t * volatile)((uint64_t)next_next & DL_NODE_DELETED_MASK) );
+              (void)lf_dlist_link_cas( &(node->next),
+                                       node_next,
+                                       (dlist_node_t *)((uint64_t)next_next & DL_NODE_DELETED_MASK) );
 #endif // IMPRV_SAFETY
               continue;
             }
@@ -163,8 +377,6 @@ dlist_node_t * lf_dlist_get_next( lf_dlist_t * volatile l, dlist_node_t * volati
 
       node = next;
 
-      mem_barrier();
-
       if( ((uint64_t)next_next & DL_NODE_DELETED) == 0 )
         {
           return (dlist_node_t *)next;
@@ -174,24 +386,23 @@ dlist_node_t * lf_dlist_get_next( lf_dlist_t * volatile l, dlist_node_t * volati
   return NULL; /*  nothing after tail */
 }
 
-dlist_node_t * lf_dlist_get_prev( lf_dlist_t * volatile l, dlist_node_t * volatile _node )
+static dlist_node_t * lf_dlist_prev_link( lf_dlist_t * volatile l, dlist_node_t * volatile _node )
 {
-  dlist_node_t * volatile node = _node;
-  dlist_node_t * volatile prev;
-  dlist_node_t * volatile prev_next;
-  dlist_node_t * volatile next;
+  dlist_node_t * node = _node;
+  dlist_node_t * prev;
+  dlist_node_t * prev_next;
+  dlist_node_t * next;
 
   while( node != l->head )
     {
       RAW_CHECK( node, "null current node" );
-      prev = lf_dlist_dereference_node_pointer_mem_only( node->prev );
+      prev = lf_dlist_dereference_node_pointer_mem_only( atomic_load_acq( &(node->prev) ) );
       RAW_CHECK( prev, "null prev pointer in list" );
 
-      prev_next = prev->next;
-      mem_barrier();
-      next = node->next;
+      prev_next = atomic_load_acq( &(prev->next) );
+      next = atomic_load_acq( &(node->next) );
 
-      if( (prev_next == node) &&
+      if( (lf_dlist_link_strip( prev_next ) == node) &&
           ((uint64_t)next & DL_NODE_DELETED) == 0 )
         {
           return (dlist_node_t *)prev;
@@ -216,399 +427,2103 @@ DL_STATUS lf_dlist_insert_before( lf_dlist_t   * volatile l,
                                   dlist_node_t * volatile _pivot,
                                   dlist_node_t * volatile _node )
 {
-  dlist_node_t * volatile pivot = _pivot;
-  dlist_node_t * volatile node  = _node;
-  dlist_node_t * volatile pivot_prev = NULL;
-  dlist_node_t * volatile pivot_next = NULL;
-  dlist_node_t * volatile expected = NULL;
+  return lf_dlist_insert_chain_before( l, _pivot, _node, _node );
+}
+
+DL_STATUS lf_dlist_insert_after( lf_dlist_t   * volatile l,
+                                 dlist_node_t * volatile _prev,
+                                 dlist_node_t * volatile _node )
+{
+  return lf_dlist_insert_chain_after( l, _prev, _node, _node );
+}
+
+void lf_dlist_chain_append( dlist_node_t ** first,
+                            dlist_node_t ** last,
+                            dlist_node_t  * node )
+{
+  lf_dlist_link_store( &(node->next), NULL );
+
+  if( *last == NULL )
+    {
+      lf_dlist_link_store( &(node->prev), NULL );
+      *first = node;
+    }
+  else
+    {
+      lf_dlist_link_store( &(node->prev), *last );
+      lf_dlist_link_store( &((*last)->next), node );
+    }
+
+  *last = node;
+}
+
+/*  Length of the private run [first .. last] */
+static int64_t lf_dlist_chain_length( dlist_node_t * volatile first,
+                                      dlist_node_t * volatile last )
+{
+  dlist_node_t * node = first;
+  int64_t        cnt  = 1;
+
+  while( node != last )
+    {
+      node = lf_dlist_link_strip( atomic_load_rlx( &(node->next) ) );
+      cnt++;
+    }
+
+  return cnt;
+}
+
+DL_STATUS lf_dlist_insert_chain_before( lf_dlist_t   * volatile l,
+                                        dlist_node_t * volatile _pivot,
+                                        dlist_node_t * volatile _first,
+                                        dlist_node_t * volatile _last )
+{
+  return lf_dlist_link_chain_before( l, _pivot, _first, _last, NULL );
+}
+
+/*  insert_chain_before; [fails] (may be NULL) counts the failed CASes on */
+/*  the predecessor's next pointer, see lf_dlist_fc_append() */
+static DL_STATUS lf_dlist_link_chain_before( lf_dlist_t   * volatile l,
+                                             dlist_node_t * volatile _pivot,
+                                             dlist_node_t * volatile _first,
+                                             dlist_node_t * volatile _last,
+                                             uint32_t              * fails )
+{
+  dlist_node_t * pivot = _pivot;
+  dlist_node_t * first = _first;
+  dlist_node_t * last  = _last;
+  dlist_node_t * pivot_prev = NULL;
+  dlist_node_t * pivot_next = NULL;
+  dlist_node_t * expected = NULL;
+  int64_t        cnt = 0;
 
   RAW_CHECK( !((uint64_t )pivot & DL_NODE_DELETED), "invalid next pointer state" );
 
   if( pivot == l->head )
     {
-      return lf_dlist_insert_after( l, pivot, node );
+      return lf_dlist_insert_chain_after( l, pivot, first, last );
     }
 
-  while( true )
+  /*  count while the run is private */
+  cnt = lf_dlist_chain_length( first, last );
+
+  lf_dlist_epoch_enter();
+
+  if( l->move_pool != NULL )
     {
-      // mem_barrier();
-      pivot_prev = lf_dlist_dereference_node_pointer_mem_only( pivot->prev );
+      /*  a moved pivot is where its holder is */
+      if( pivot != l->tail )
+        {
+          pivot = lf_dlist_move_hook( l, pivot );
+        }
+      lf_dlist_move_clear_chain( l, first, last );
+    }
 
+  pivot_prev = lf_dlist_dereference_node_pointer_mem_only( atomic_load_acq( &(pivot->prev) ) );
+
+  while( true )
+    {
       /*  If the guy supposed to be behind me got deleted, fast */
       /*  forward to its next node and retry */
-      pivot_next = pivot->next;
+      pivot_next = atomic_load_acq( &(pivot->next) );
       if( (uint64_t)pivot_next & DL_NODE_DELETED )
         {
-          pivot = lf_dlist_get_next( l, pivot );
+          pivot = lf_dlist_next_link( l, pivot );
+          RAW_CHECK( pivot, "deleted pivot without live successor" );
           pivot_prev = lf_dlist_correct_prev( l, pivot_prev, pivot ); /*  using the new pivot */
-          continue;
         }
+      else
+        {
+          /*  The run is still private, the CAS below publishes all of it */
+          lf_dlist_link_store( &(first->prev), pivot_prev );
+          lf_dlist_link_store( &(last->next), pivot );
+
+          /*  Install [first] on prev->next */
+          expected = atomic_load_acq( &(pivot_prev->next) );
+          if( lf_dlist_link_strip( expected ) == pivot &&
+              lf_dlist_link_cas( &(pivot_prev->next), expected, first ) )
+            {
+              break;
+            }
 
-      node->prev = (dlist_node_t * volatile)((uint64_t)pivot_prev & DL_NODE_DELETED_MASK);
-      node->next = (dlist_node_t * volatile)((uint64_t)pivot & DL_NODE_DELETED_MASK);
-
-      mem_barrier();
+          /*  Failed, get a new hopefully-correct prev; repairing the links */
+          /*  around [pivot] is local work, never a fresh traversal */
+          if( fails != NULL )
+            {
+              (*fails)++;
+            }
+          pivot_prev = lf_dlist_correct_prev( l, pivot_prev, pivot );
+          lf_dlist_backoff( l );
+        }
 
-      /*  Install [node] on prev->next */
-      expected = (dlist_node_t * volatile)((uint64_t)pivot & DL_NODE_DELETED_MASK);
-      if( expected == atomic_cas_64( &(pivot_prev->next),
-                                     expected,
-                                     node ) )
+      pivot_prev = lf_dlist_dereference_node_pointer_mem_only( pivot_prev );
+      if( pivot_prev == NULL )
         {
-          mem_barrier();
-          break;
+          pivot_prev = lf_dlist_dereference_node_pointer_mem_only( atomic_load_acq( &(pivot->prev) ) );
         }
+    }
 
-#if 1
-      pivot_prev = lf_dlist_correct_prev( l, pivot_prev, pivot );
-
-      lf_dlist_backoff( l );
-      mem_barrier();
-      lf_dlist_backoff( l );
+  lf_dlist_size_add( l, cnt );
 
-      return DL_STATUS_MERGE_IN_PROGRESS;
-#else
-      /*  Failed, get a new hopefully-correct prev */
-      pivot_prev = lf_dlist_correct_prev( l, pivot_prev, next );
-      lf_dlist_backoff( l );
-#endif
+  /*  pivot->prev still points in front of the run: start the repair from */
+  /*  [last] so it does not walk over the run */
+  lf_dlist_correct_prev( l, last, pivot );
+  if( l->index != NULL || l->hash != NULL )
+    {
+      lf_dlist_index_add_chain( l, first, last );
     }
-
-  RAW_CHECK( pivot_prev, "invalid prev pointer" );
-  lf_dlist_correct_prev( l, pivot_prev, pivot);
+  lf_dlist_backoff_reset( l );
+  lf_dlist_epoch_exit();
 
   return DL_STATUS_OK;
 }
 
-DL_STATUS lf_dlist_insert_after( lf_dlist_t   * volatile l,
-                                 dlist_node_t * volatile _prev,
-                                 dlist_node_t * volatile _node )
+DL_STATUS lf_dlist_insert_chain_after( lf_dlist_t   * volatile l,
+                                       dlist_node_t * volatile _prev,
+                                       dlist_node_t * volatile _first,
+                                       dlist_node_t * volatile _last )
 {
-  dlist_node_t * volatile prev = _prev;
-  dlist_node_t * volatile node = _node;
-  dlist_node_t * volatile prev_next = NULL;
-  dlist_node_t * volatile expected = NULL;
+  dlist_node_t * prev  = _prev;
+  dlist_node_t * first = _first;
+  dlist_node_t * last  = _last;
+  dlist_node_t * prev_next = NULL;
+  DL_STATUS      st = DL_STATUS_OK;
+  int64_t        cnt = 0;
 
   RAW_CHECK( !((uint64_t )prev & DL_NODE_DELETED), "invalid prev pointer state" );
 
   if( prev == l->tail )
     {
-      return lf_dlist_insert_before( l, prev, node );
+      return lf_dlist_insert_chain_before( l, prev, first, last );
     }
 
-  while( true )
-    {
-      mem_barrier();
-      prev_next = prev->next;
-      node->prev = (dlist_node_t * volatile)((uint64_t)prev & DL_NODE_DELETED_MASK);
-      node->next = (dlist_node_t * volatile)((uint64_t)prev_next & DL_NODE_DELETED_MASK);
+  cnt = lf_dlist_chain_length( first, last );
 
-      mem_barrier();
+  lf_dlist_epoch_enter();
 
-      /*  Install [node] after [next] */
-      expected = (dlist_node_t * volatile)((uint64_t)prev_next & DL_NODE_DELETED_MASK);
-      if( expected == atomic_cas_64( &prev->next, expected, node ) )
+  if( l->move_pool != NULL )
+    {
+      if( prev != l->head )
         {
-          mem_barrier();
-          break;
+          prev = lf_dlist_move_hook( l, prev );
         }
+      lf_dlist_move_clear_chain( l, first, last );
+    }
 
+  while( true )
+    {
+      prev_next = atomic_load_acq( &(prev->next) );
       if( (uint64_t)prev_next & DL_NODE_DELETED )
         {
-          return DL_STATUS_MERGE_IN_PROGRESS;
+          /*  [prev] got deleted: the position right after it is now in */
+          /*  front of its (former) successor */
+          st = lf_dlist_insert_chain_before( l,
+                                             lf_dlist_dereference_node_pointer_mem_only( prev_next ),
+                                             first,
+                                             last );
+          lf_dlist_epoch_exit();
+          return st;
+        }
+
+      lf_dlist_link_store( &(first->prev), prev );
+      lf_dlist_link_store( &(last->next), prev_next );
+
+      /*  Install [first] after [prev] */
+      if( lf_dlist_link_cas( &(prev->next), prev_next, first ) )
+        {
+          break;
         }
 
       lf_dlist_backoff( l );
-      return DL_STATUS_MERGE_IN_PROGRESS;
     }
 
+  lf_dlist_size_add( l, cnt );
+
   RAW_CHECK( prev_next, "invalid prev_next pointer" );
-  lf_dlist_correct_prev( l, prev, prev_next );
+  lf_dlist_correct_prev( l, last, lf_dlist_link_strip( prev_next ) );
+  if( l->index != NULL || l->hash != NULL )
+    {
+      lf_dlist_index_add_chain( l, first, last );
+    }
+  lf_dlist_backoff_reset( l );
+  lf_dlist_epoch_exit();
   return DL_STATUS_OK;
 }
 
+/* ****************************************************************************
+ * Deque operations (PushLeft/PushRight/PopLeft/PopRight of the paper).
+ * The end is known, so no cursor is needed and the successor's prev pointer
+ * is set directly by lf_dlist_push_common() instead of the correct_prev walk.
+ */
 
-#if 0
-리스트 노드 삭제시 lf_dlist_delete()를 호출하는데,
-  이후에 lf_dlist_correct_next()를 호출해야 한다.
-  사용방법과 이유는 아래와 같다.
-{
-  cur_node_next = cursor->cur_node->next;
-  if( DL_STATUS_OK == lf_dlist_delete( cursor->l, cursor->cur_node ) )
-    {
-      /* IMPORTANT:
-       * 아래 함수 호출 이전까지 아래와 같은 상황이다.
-       * node1    <-------------------  node2
-       *   |  \-----d---|                 ^
-       *   ---------->  delnode -----d----|
-       *
-       *   따라서 아래함수를 호출하여
-       * node1  <----------------->   node2
-       *     ^                          ^
-       *     ----d---- delnode ----d----|
-       *  와 같은 생태로 만들어 준다*/
-      for( tmp = cursor->l->head; tmp != cursor->l->tail ; )
-        {
-          tmp = lf_dlist_correct_next( cursor->l,
-                                       lf_dlist_dereference_node_pointer( cursor->l,
-                                                                          &tmp ) );
-          if( tmp == cur_node_next )
+/*  [node] was just linked in front of [next]: make next->prev point to it. */
+/*  Only if someone else got in between, fall back to correct_prev(). */
+static void lf_dlist_push_common( lf_dlist_t   * volatile l,
+                                  dlist_node_t * volatile node,
+                                  dlist_node_t * volatile next )
+{
+  dlist_node_t * link1 = NULL;
+
+  while( true )
+    {
+      link1 = atomic_load_acq( &(next->prev) );
+      if( ((uint64_t)link1 & DL_NODE_DELETED) ||
+          lf_dlist_link_strip( atomic_load_acq( &(node->next) ) ) != next )
+        {
+          /*  [next] is being deleted or a new node is behind [node]: */
+          /*  whoever did that fixes next->prev */
+          break;
+        }
+
+      if( lf_dlist_link_cas( &(next->prev), link1, node ) )
+        {
+          if( lf_dlist_marked_prev( node ) )
             {
-              break;
+              /*  [node] got popped meanwhile */
+              (void)lf_dlist_correct_prev( l, node, next );
             }
+          break;
         }
+
+      lf_dlist_backoff( l );
     }
 }
-#endif
 
-DL_STATUS lf_dlist_delete( lf_dlist_t * volatile l, dlist_node_t * volatile _node )
+DL_STATUS lf_dlist_push_front( lf_dlist_t   * volatile l,
+                               dlist_node_t * volatile _node )
 {
-  dlist_node_t * volatile node = _node;
-  dlist_node_t * volatile node_next = NULL;
-  dlist_node_t * volatile desired   = NULL;
-  dlist_node_t * volatile rnode     = NULL;
-  dlist_node_t * volatile node_prev = NULL;
+  dlist_node_t * node = _node;
 
-  if( node == l->head || node == l->tail )
+  lf_dlist_epoch_enter();
+
+  if( l->move_pool != NULL )
     {
-      RAW_CHECK( ((uint64_t )node->next & DL_NODE_DELETED) == 0,
-                 "invalid next pointer" );
-      RAW_CHECK( ((uint64_t )node->prev & DL_NODE_DELETED) == 0,
-                 "invalid next pointer" );
+      lf_dlist_move_clear_chain( l, node, node );
+    }
+  lf_dlist_push_link_front( l, node );
+  lf_dlist_size_add( l, 1 );
+  lf_dlist_backoff_reset( l );
+  lf_dlist_epoch_exit();
 
-      return DL_STATUS_OK;
+  return DL_STATUS_OK;
+}
+
+DL_STATUS lf_dlist_push_back( lf_dlist_t   * volatile l,
+                              dlist_node_t * volatile _node )
+{
+  dlist_node_t * node = _node;
+
+  lf_dlist_epoch_enter();
+
+  if( l->move_pool != NULL )
+    {
+      lf_dlist_move_clear_chain( l, node, node );
     }
+  lf_dlist_push_link_back( l, node );
+  lf_dlist_size_add( l, 1 );
+  lf_dlist_backoff_reset( l );
+  lf_dlist_epoch_exit();
+
+  return DL_STATUS_OK;
+}
+
+/*  Link [node] right behind the head; push_front() without the size, also */
+/*  links the proxies of lf_dlist_move() */
+static void lf_dlist_push_link_front( lf_dlist_t   * volatile l,
+                                      dlist_node_t * volatile node )
+{
+  dlist_node_t * prev = l->head;
+  dlist_node_t * next = NULL;
 
   while( true )
     {
-      mem_barrier();
-      node_next = node->next;
-      if( (uint64_t)node_next & DL_NODE_DELETED )
+      /*  head is never deleted, its next pointer is never marked */
+      next = atomic_load_acq( &(prev->next) );
+
+      lf_dlist_link_store( &(node->prev), prev );
+      lf_dlist_link_store( &(node->next), next );
+
+      if( lf_dlist_link_cas( &(prev->next), next, node ) )
         {
-          return DL_STATUS_OK;
+          break;
         }
 
-      /*  Try to set the deleted bit in node->next */
-      desired = (dlist_node_t * volatile)((uint64_t)node_next | DL_NODE_DELETED);
-
-      rnode = atomic_cas_64( &(node->next), node_next, desired );
+      lf_dlist_backoff( l );
+    }
 
-      if( rnode == node_next )
-        {
-          node_prev = NULL;
-          while( true )
-            {
-              mem_barrier();
-              node_prev = node->prev;
-              if( (uint64_t)node_prev & DL_NODE_DELETED )
-                {
-                  break;
-                }
+  lf_dlist_push_common( l, node, lf_dlist_link_strip( next ) );
+}
 
-              desired = (dlist_node_t * volatile)((uint64_t)node_prev | DL_NODE_DELETED);
+/*  Link [node] right in front of the tail, as push_link_front() */
+static void lf_dlist_push_link_back( lf_dlist_t   * volatile l,
+                                     dlist_node_t * volatile node )
+{
+  dlist_node_t * next = l->tail;
+  dlist_node_t * prev = NULL;
+  dlist_node_t * prev_next = NULL;
 
-              if( node_prev == atomic_cas_64( &node->prev, node_prev, desired ) )
-                {
-                  mem_barrier();
-                  break;
-                }
-            }
+  prev = lf_dlist_dereference_node_pointer_mem_only( atomic_load_acq( &(next->prev) ) );
 
-          RAW_CHECK( ((uint64_t )l->head->next & DL_NODE_DELETED) == 0,
-                     "invalid next pointer" );
+  while( true )
+    {
+      lf_dlist_link_store( &(node->prev), prev );
+      lf_dlist_link_store( &(node->next), next );
 
-          mem_barrier();
-          lf_dlist_correct_prev( l,
-                                 (dlist_node_t * volatile)((uint64_t)node_prev & DL_NODE_DELETED_MASK),
-                                 node_next );
+      prev_next = atomic_load_acq( &(prev->next) );
+      if( lf_dlist_link_strip( prev_next ) == next &&
+          lf_dlist_link_cas( &(prev->next), prev_next, node ) )
+        {
+          break;
+        }
 
-          return DL_STATUS_OK;
+      /*  [prev] is not the last node anymore (or is being popped) */
+      prev = lf_dlist_dereference_node_pointer_mem_only( lf_dlist_correct_prev( l, prev, next ) );
+      if( prev == NULL )
+        {
+          prev = lf_dlist_dereference_node_pointer_mem_only( atomic_load_acq( &(next->prev) ) );
         }
+      lf_dlist_backoff( l );
     }
+
+  lf_dlist_push_common( l, node, next );
 }
 
-static dlist_node_t * lf_dlist_correct_prev( lf_dlist_t   * volatile l,
-                                             dlist_node_t * volatile _prev,
-                                             dlist_node_t * volatile _node )
+DL_STATUS lf_dlist_pop_front( lf_dlist_t    * volatile l,
+                              dlist_node_t ** _node )
 {
-  dlist_node_t * volatile prev = _prev;
-  dlist_node_t * volatile node = _node;
-  dlist_node_t * volatile link1 = NULL;
-  dlist_node_t * volatile last_link = NULL;
-  dlist_node_t * volatile prev_next = NULL;
-  dlist_node_t * volatile desired   = NULL;
-  dlist_node_t * volatile p         = NULL;
-  dlist_node_t * volatile prev_cleared      = NULL;
-  dlist_node_t * volatile prev_cleared_prev = NULL;
+  dlist_node_t * prev = l->head;
+  dlist_node_t * node = NULL;
+  dlist_node_t * next = NULL;
+  dlist_node_t * prev_next = NULL;
 
-  RAW_CHECK( ((uint64_t )node & DL_NODE_DELETED) == 0, "node has deleted mark" );
-  RAW_CHECK( prev, "invalid prev pointer" );
+  if( l->move_pool != NULL )
+    {
+      return lf_dlist_move_pop( l, _node, true );
+    }
+
+  lf_dlist_epoch_enter();
 
   while( true )
     {
-      mem_barrier();
-      link1 = node->prev;
-      if( (uint64_t)link1 & DL_NODE_DELETED )
+      prev_next = atomic_load_acq( &(prev->next) );
+      node = lf_dlist_link_strip( prev_next );
+      if( node == l->tail )
         {
-          break;
+          *_node = NULL;
+          lf_dlist_epoch_exit();
+          return DL_STATUS_NOT_FOUND;
         }
 
-      prev_cleared = (dlist_node_t * volatile)((uint64_t)prev & DL_NODE_DELETED_MASK);
-#if 1
-      if( prev_cleared == NULL )
+      next = atomic_load_acq( &(node->next) );
+      if( (uint64_t)next & DL_NODE_DELETED )
         {
-          return NULL;
+          /*  help the pop (or delete) in progress to unlink [node] */
+          lf_dlist_mark_node_pointer( l, &(node->prev) );
+          (void)lf_dlist_link_cas( &(prev->next),
+                                   prev_next,
+                                   lf_dlist_dereference_node_pointer_mem_only( next ) );
+          continue;
         }
-#endif
 
-      mem_barrier();
-      prev_next = prev_cleared->next;
-      if( (uint64_t)prev_next & DL_NODE_DELETED )
+      if( lf_dlist_link_cas( &(node->next), next, (dlist_node_t *)((uint64_t)next | DL_NODE_DELETED) ) )
         {
-          if( last_link )
-            {
-              lf_dlist_mark_node_pointer( l, (dlist_node_t ** volatile)&prev_cleared->prev );
-              mem_barrier();
+          lf_dlist_size_add( l, -1 );
+          lf_dlist_index_remove( l, node );
+          break;
+        }
 
-              desired = (dlist_node_t * volatile)(((uint64_t)prev_next & DL_NODE_DELETED_MASK));
-              (void)atomic_cas_64( &(last_link->next), prev, desired );
-              prev = last_link;
-              last_link = NULL;
+      lf_dlist_backoff( l );
+    }
+
+  lf_dlist_mark_node_pointer( l, &(node->prev) );
+  /*  unlinks [node] and sets next->prev to head */
+  (void)lf_dlist_correct_prev( l, prev, lf_dlist_link_strip( next ) );
+  lf_dlist_backoff_reset( l );
+  lf_dlist_epoch_exit();
+
+  *_node = node;
+  return DL_STATUS_OK;
+}
+
+DL_STATUS lf_dlist_pop_back( lf_dlist_t    * volatile l,
+                             dlist_node_t ** _node )
+{
+  dlist_node_t * next = l->tail;
+  dlist_node_t * node = NULL;
+  dlist_node_t * prev = NULL;
+  dlist_node_t * node_next = NULL;
+
+  if( l->move_pool != NULL )
+    {
+      return lf_dlist_move_pop( l, _node, false );
+    }
+
+  lf_dlist_epoch_enter();
+
+  node = lf_dlist_dereference_node_pointer_mem_only( atomic_load_acq( &(next->prev) ) );
+
+  while( true )
+    {
+      node_next = atomic_load_acq( &(node->next) );
+      if( lf_dlist_link_strip( node_next ) != next )
+        {
+          /*  tail->prev is stale or [node] is being deleted */
+          node = lf_dlist_dereference_node_pointer_mem_only( lf_dlist_correct_prev( l, node, next ) );
+          if( node == NULL )
+            {
+              node = lf_dlist_dereference_node_pointer_mem_only( atomic_load_acq( &(next->prev) ) );
+            }
+          continue;
+        }
+
+      if( node == l->head )
+        {
+          *_node = NULL;
+          lf_dlist_epoch_exit();
+          return DL_STATUS_NOT_FOUND;
+        }
+
+      if( lf_dlist_link_cas( &(node->next), node_next, (dlist_node_t *)((uint64_t)next | DL_NODE_DELETED) ) )
+        {
+          lf_dlist_size_add( l, -1 );
+          lf_dlist_index_remove( l, node );
+          break;
+        }
+
+      lf_dlist_backoff( l );
+    }
+
+  lf_dlist_mark_node_pointer( l, &(node->prev) );
+  prev = lf_dlist_dereference_node_pointer_mem_only( atomic_load_acq( &(node->prev) ) );
+  /*  unlinks [node] and sets tail->prev to [prev] */
+  (void)lf_dlist_correct_prev( l, prev, next );
+  lf_dlist_backoff_reset( l );
+  lf_dlist_epoch_exit();
+
+  *_node = node;
+  return DL_STATUS_OK;
+}
+
+DL_STATUS lf_dlist_delete( lf_dlist_t * volatile l, dlist_node_t * volatile node )
+{
+  if( node == l->head || node == l->tail )
+    {
+      RAW_CHECK( ((uint64_t )node->next & DL_NODE_DELETED) == 0,
+                 "invalid next pointer" );
+      RAW_CHECK( ((uint64_t )node->prev & DL_NODE_DELETED) == 0,
+                 "invalid next pointer" );
+
+      return DL_STATUS_OK;
+    }
+
+  return lf_dlist_delete_node( l, node );
+}
+
+/*  Delete [node]: OK, or NOT_FOUND if someone else deleted it first */
+static DL_STATUS lf_dlist_delete_node( lf_dlist_t * volatile l, dlist_node_t * volatile _node )
+{
+  dlist_node_t * node = _node;
+  dlist_node_t * node_next = NULL;
+
+  if( l->move_pool != NULL )
+    {
+      return lf_dlist_move_delete( l, node );
+    }
+
+  lf_dlist_epoch_enter();
+
+  /*  Try to set the deleted bit in node->next */
+  if( lf_dlist_mark_deleted( l, node ) != DL_STATUS_OK )
+    {
+      lf_dlist_backoff_reset( l );
+      lf_dlist_epoch_exit();
+      return DL_STATUS_NOT_FOUND;
+    }
+  node_next = atomic_load_acq( &(node->next) );
+
+  lf_dlist_size_add( l, -1 );
+  lf_dlist_index_remove( l, node );
+
+  lf_dlist_unlink_marked( l, node, node_next );
+  lf_dlist_backoff_reset( l );
+  lf_dlist_epoch_exit();
+
+  return DL_STATUS_OK;
+}
+
+/*  The physical part of a delete: mark the prev pointer of [node], whose */
+/*  next pointer [node_next] is marked, and unlink it */
+static void lf_dlist_unlink_marked( lf_dlist_t   * volatile l,
+                                    dlist_node_t * volatile node,
+                                    dlist_node_t * volatile node_next )
+{
+  dlist_node_t * desired   = NULL;
+  dlist_node_t * node_prev = NULL;
+
+  while( true )
+    {
+      node_prev = atomic_load_acq( &(node->prev) );
+      if( (uint64_t)node_prev & DL_NODE_DELETED )
+        {
+          break;
+        }
+
+      desired = (dlist_node_t *)((uint64_t)node_prev | DL_NODE_DELETED);
+
+      if( lf_dlist_link_cas( &(node->prev), node_prev, desired ) )
+        {
+          break;
+        }
+    }
+
+  RAW_CHECK( ((uint64_t )l->head->next & DL_NODE_DELETED) == 0,
+             "invalid next pointer" );
+
+  lf_dlist_correct_prev( l,
+                         (dlist_node_t *)((uint64_t)node_prev & DL_NODE_DELETED_MASK),
+                         lf_dlist_dereference_node_pointer_mem_only( node_next ) );
+}
+
+/*  Logically delete [node]: set the deleted bit of its next pointer. */
+/*  DL_STATUS_OK if this call did, then the caller accounts for the node, */
+/*  DL_STATUS_NOT_FOUND if someone else deleted it first. */
+static DL_STATUS lf_dlist_mark_deleted( lf_dlist_t * volatile l, dlist_node_t * volatile node )
+{
+  dlist_node_t * node_next = NULL;
+
+  while( true )
+    {
+      node_next = atomic_load_acq( &(node->next) );
+      if( (uint64_t)node_next & DL_NODE_DELETED )
+        {
+          return DL_STATUS_NOT_FOUND;
+        }
+
+      if( lf_dlist_link_cas( &(node->next),
+                             node_next,
+                             (dlist_node_t *)((uint64_t)node_next | DL_NODE_DELETED) ) )
+        {
+          return DL_STATUS_OK;
+        }
+
+      lf_dlist_backoff( l );
+    }
+}
+
+DL_STATUS lf_dlist_delete_range( lf_dlist_t   * volatile l,
+                                 dlist_node_t * volatile first,
+                                 dlist_node_t * volatile last )
+{
+  return lf_dlist_unlink_range( l, first, last, NULL, 0, NULL, NULL );
+}
+
+/*  Add the [hook_offset] hook of [node] to the run [*hfirst .. *hlast], if */
+/*  there is one */
+#define lf_dlist_hook_append( _hfirst, _hlast, _node, _hook_offset )         \
+  do {                                                                      \
+    if( (_hfirst) != NULL )                                                 \
+      {                                                                     \
+        lf_dlist_chain_append( (_hfirst), (_hlast),                         \
+                               (dlist_node_t *)((char *)(_node) + (_hook_offset)) ); \
+      }                                                                     \
+  } while( 0 )
+
+/*  lf_dlist_delete_range(); the nodes this call deleted are chained on */
+/*  their [hook_offset] hooks into [*hfirst .. *hlast] if [hfirst] is set. */
+/*  [*end] (if set) gets the node the run really ended at, which is before */
+/*  [_last] on DL_STATUS_INCOMPLETE, or NULL if nothing was unlinked */
+static DL_STATUS lf_dlist_unlink_range( lf_dlist_t   * volatile l,
+                                        dlist_node_t * volatile _first,
+                                        dlist_node_t * volatile _last,
+                                        dlist_node_t         ** end,
+                                        ptrdiff_t               hook_offset,
+                                        dlist_node_t         ** hfirst,
+                                        dlist_node_t         ** hlast )
+{
+  dlist_node_t * first = _first;
+  dlist_node_t * last  = _last;
+  dlist_node_t * node  = NULL;
+  dlist_node_t * pred  = NULL;
+  dlist_node_t * succ  = NULL;
+  dlist_node_t * pred_next = NULL;
+  dlist_node_t * marked = NULL;
+  DL_STATUS      st    = DL_STATUS_OK;
+  int64_t        cnt   = 0;
+
+  if( end != NULL )
+    {
+      *end = NULL;
+    }
+
+  if( l->move_pool != NULL )
+    {
+      /*  the run may be made of proxies */
+      return DL_STATUS_NOT_SUPPORTED;
+    }
+
+  if( first == l->head || first == l->tail ||
+      last  == l->head || last  == l->tail )
+    {
+      return DL_STATUS_INVALID_ARGUMENT;
+    }
+
+  if( first == last )
+    {
+      if( lf_dlist_delete_node( l, first ) == DL_STATUS_OK )
+        {
+          lf_dlist_hook_append( hfirst, hlast, first, hook_offset );
+        }
+      if( end != NULL )
+        {
+          *end = first;
+        }
+      return DL_STATUS_OK;
+    }
+
+  lf_dlist_epoch_enter();
+
+  /*  1. Logically delete the run: set the deleted bit of every next pointer */
+  /*  from [first] on. A marked next pointer is never changed again, so the */
+  /*  part of the run behind us can neither grow nor be re-linked. */
+  node = first;
+  while( true )
+    {
+      if( node != last && lf_dlist_marked_next( last ) )
+        {
+          /*  [last] got deleted by someone else and may already be */
+          /*  unlinked, so we could walk past it: stop at what is marked */
+          st = DL_STATUS_INCOMPLETE;
+          if( marked == NULL )
+            {
+              lf_dlist_epoch_exit();
+              return st;
+            }
+          node = marked;
+          break;
+        }
+
+      if( lf_dlist_mark_deleted( l, node ) == DL_STATUS_OK )
+        {
+          cnt++;
+          lf_dlist_index_remove( l, node );
+          lf_dlist_hook_append( hfirst, hlast, node, hook_offset );
+        }
+      marked = node;
+
+      succ = lf_dlist_dereference_node_pointer_mem_only( atomic_load_acq( &(node->next) ) );
+      RAW_CHECK( succ != l->tail || node == last, "[last] does not follow [first]" );
+      if( node == last || succ == l->tail )
+        {
+          break;
+        }
+
+      node = succ;
+    }
+  last = node;
+  if( end != NULL )
+    {
+      *end = last;
+    }
+  lf_dlist_size_add( l, -cnt );
+
+  /*  2. Mark the prev pointers as well, as lf_dlist_delete() does */
+  for( node = first ; ; node = lf_dlist_dereference_node_pointer_mem_only( atomic_load_acq( &(node->next) ) ) )
+    {
+      lf_dlist_mark_node_pointer( l, &(node->prev) );
+      if( node == last )
+        {
+          break;
+        }
+    }
+
+  /*  3. Physically unlink the whole run with one CAS on the surviving */
+  /*  predecessor. If it is gone or its next pointer moved meanwhile, */
+  /*  correct_prev() unlinks whatever is left node by node. */
+  pred = lf_dlist_dereference_node_pointer_mem_only( atomic_load_acq( &(first->prev) ) );
+  succ = lf_dlist_dereference_node_pointer_mem_only( atomic_load_acq( &(last->next) ) );
+
+  pred_next = atomic_load_acq( &(pred->next) );
+  if( lf_dlist_link_strip( pred_next ) == first )
+    {
+      (void)lf_dlist_link_cas( &(pred->next), pred_next, succ );
+    }
+
+  /*  Fix succ->prev (or finish the unlink) */
+  lf_dlist_correct_prev( l, pred, succ );
+  lf_dlist_backoff_reset( l );
+  lf_dlist_epoch_exit();
+
+  return st;
+}
+
+DL_STATUS lf_dlist_take_prefix( lf_dlist_t    * volatile l,
+                                int64_t                  n,
+                                dlist_node_t          ** first,
+                                dlist_node_t          ** last )
+{
+  dlist_node_t * node = NULL;
+  dlist_node_t * next = NULL;
+  DL_STATUS      st   = DL_STATUS_OK;
+  int64_t        i    = 0;
+
+  *first = NULL;
+  *last  = NULL;
+
+  if( n <= 0 )
+    {
+      return DL_STATUS_INVALID_ARGUMENT;
+    }
+
+  lf_dlist_epoch_enter();
+
+  node = lf_dlist_get_next( l, l->head );
+  if( node == l->tail || node == NULL )
+    {
+      lf_dlist_epoch_exit();
+      return DL_STATUS_NOT_FOUND;
+    }
+  *first = node;
+
+  for( i = 1 ; i < n ; i++ )
+    {
+      next = lf_dlist_get_next( l, node );
+      if( next == l->tail || next == NULL )
+        {
+          break;
+        }
+      node = next;
+    }
+  *last = node;
+
+  /*  The nodes are marked one by one - a node someone is inserting behind */
+  /*  must not get lost - but unlinked with a single CAS on head->next */
+  st = lf_dlist_unlink_range( l, *first, *last, last, 0, NULL, NULL );
+  if( *last == NULL )
+    {
+      *first = NULL;
+    }
+  lf_dlist_epoch_exit();
+
+  return st;
+}
+
+DL_STATUS lf_dlist_take_all( lf_dlist_t    * volatile l,
+                             dlist_node_t          ** first,
+                             dlist_node_t          ** last )
+{
+  DL_STATUS st = DL_STATUS_OK;
+
+  *first = NULL;
+  *last  = NULL;
+
+  lf_dlist_epoch_enter();
+
+  *first = lf_dlist_get_next( l, l->head );
+  *last  = lf_dlist_get_prev( l, l->tail );
+  if( *first == l->tail || *first == NULL || *last == l->head || *last == NULL )
+    {
+      *first = NULL;
+      *last  = NULL;
+      lf_dlist_epoch_exit();
+      return DL_STATUS_NOT_FOUND;
+    }
+
+  st = lf_dlist_unlink_range( l, *first, *last, last, 0, NULL, NULL );
+  if( *last == NULL )
+    {
+      *first = NULL;
+    }
+  lf_dlist_epoch_exit();
+
+  return st;
+}
+
+DL_STATUS lf_dlist_transfer( lf_dlist_t   * volatile src,
+                             lf_dlist_t   * volatile dst,
+                             dlist_node_t * volatile node,
+                             ptrdiff_t               dst_hook_offset )
+{
+  return lf_dlist_transfer_range( src, dst, node, node, dst_hook_offset );
+}
+
+DL_STATUS lf_dlist_transfer_range( lf_dlist_t   * volatile src,
+                                   lf_dlist_t   * volatile dst,
+                                   dlist_node_t * volatile first,
+                                   dlist_node_t * volatile last,
+                                   ptrdiff_t               dst_hook_offset )
+{
+  dlist_node_t * hfirst = NULL;
+  dlist_node_t * hlast  = NULL;
+  DL_STATUS      st     = DL_STATUS_OK;
+  DL_STATUS      ins    = DL_STATUS_OK;
+
+  if( dst_hook_offset == 0 )
+    {
+      /*  the hooks would overlap: dst could not be written before the */
+      /*  node is unlinked from src */
+      return DL_STATUS_INVALID_ARGUMENT;
+    }
+
+  /*  The hooks of the nodes we delete are ours as soon as the deleted bit */
+  /*  is set: they are chained while src is still being unlinked, and the */
+  /*  whole chain is published into dst with one CAS */
+  st = lf_dlist_unlink_range( src, first, last, NULL, dst_hook_offset, &hfirst, &hlast );
+  if( hfirst == NULL )
+    {
+      return ( st == DL_STATUS_INVALID_ARGUMENT || st == DL_STATUS_NOT_SUPPORTED ) ? st : DL_STATUS_NOT_FOUND;
+    }
+
+  /*  Linking before the tail cannot fail: the tail is never deleted, so */
+  /*  the loop retries until the CAS goes through */
+  ins = lf_dlist_insert_chain_before( dst, dst->tail, hfirst, hlast );
+  RAW_CHECK( ins == DL_STATUS_OK, "chain lost between src and dst" );
+  (void)ins;
+
+  return st;
+}
+
+/* ****************************************************************************
+ * Moving a node (LRU promotion).
+ * A node of a list with moves is held by one hook at a time: its own link,
+ * or a proxy from l->move_pool linked at the end it was moved to. Its
+ * lf_dlist_move_ref_t names the holder (NULL for its own link). A proxy
+ * has the same slot [move_ref_offset] bytes from its hook, with the node
+ * it stands for and DL_NODE_DIRTY, which a holder never has, so any hook
+ * met on a link tells what it is. A move links a new proxy first and then
+ * switches the holder to it with a CAS, so a linked hook holds the node
+ * all the time. A delete or pop sets DL_NODE_DELETED on the holder, which
+ * makes a later switch fail. Readers step over hooks that do not hold
+ * their node, and whoever made a hook lose its node unlinks it: the mover
+ * the old holder (or its own proxy if the switch failed), the delete or
+ * pop the last holder. A proxy is retired by the one that unlinks it; the
+ * own link of a node is only linked again by an insert of the node, so
+ * nothing has to wait for a grace period.
+ */
+
+int32_t lf_dlist_move_create( lf_dlist_t * volatile l, ptrdiff_t ref_offset )
+{
+  node_pool_t * pool = NULL;
+  ptrdiff_t     lo   = ( ref_offset < 0 ) ? ref_offset : 0;
+  ptrdiff_t     hi   = (ptrdiff_t)sizeof(dlist_node_t);
+
+  TRY( l->move_pool != NULL || l->index != NULL );
+  /*  the slot must not overlap the link */
+  TRY( ref_offset > -(ptrdiff_t)sizeof(lf_dlist_move_ref_t) &&
+       ref_offset < (ptrdiff_t)sizeof(dlist_node_t) );
+  /*  the nodes already linked have no slot set up */
+  TRY( lf_dlist_link_strip( atomic_load_acq( &(l->head->next) ) ) != l->tail );
+
+  if( ref_offset + (ptrdiff_t)sizeof(lf_dlist_move_ref_t) > hi )
+    {
+      hi = ref_offset + (ptrdiff_t)sizeof(lf_dlist_move_ref_t);
+    }
+  TRY( node_pool_create( &pool, (uint32_t)(hi - lo), 0 ) != RC_SUCCESS );
+
+  l->move_ref_offset = ref_offset;
+  l->move_pool       = pool;
+
+  return RC_SUCCESS;
+
+  CATCH_END;
+
+  return RC_FAIL;
+}
+
+void lf_dlist_move_destroy( lf_dlist_t * volatile l )
+{
+  node_pool_destroy( l->move_pool );
+  l->move_pool = NULL;
+}
+
+/*  The hook holding [node], or the one that held it last if it is */
+/*  deleted. [node] may be a proxy already, e.g. a pivot read off a link. */
+static dlist_node_t * lf_dlist_move_hook( lf_dlist_t * volatile l, dlist_node_t * volatile node )
+{
+  uint64_t ref = (uint64_t)atomic_load_acq( &(lf_dlist_move_ref( l, node )->holder) );
+
+  if( ref & DL_NODE_DIRTY )
+    {
+      return node;
+    }
+
+  ref &= ~DL_NODE_DELETED;
+  return ( ref != 0 ) ? (dlist_node_t *)ref : node;
+}
+
+/*  The node [hook] holds, NULL if it holds none: the own link of a node */
+/*  that was moved away, a proxy that was moved away from or lost its */
+/*  switch, or the last holder of a deleted node */
+static dlist_node_t * lf_dlist_move_entry( lf_dlist_t * volatile l, dlist_node_t * volatile hook )
+{
+  dlist_node_t * node = hook;
+  uint64_t       ref  = (uint64_t)atomic_load_acq( &(lf_dlist_move_ref( l, hook )->holder) );
+
+  if( ref & DL_NODE_DIRTY )
+    {
+      node = (dlist_node_t *)(ref & ~DL_NODE_DIRTY);
+      ref  = (uint64_t)atomic_load_acq( &(lf_dlist_move_ref( l, node )->holder) );
+    }
+
+  if( ref & DL_NODE_DELETED )
+    {
+      return NULL;
+    }
+
+  return ( ((ref != 0) ? (dlist_node_t *)ref : node) == hook ) ? node : NULL;
+}
+
+/*  The nodes of a run inserted into a list with moves are on their own */
+/*  links; the run is still private */
+static void lf_dlist_move_clear_chain( lf_dlist_t   * volatile l,
+                                       dlist_node_t * volatile first,
+                                       dlist_node_t * volatile last )
+{
+  dlist_node_t * node = first;
+
+  while( true )
+    {
+      atomic_store_rlx( &(lf_dlist_move_ref( l, node )->holder), NULL );
+      if( node == last )
+        {
+          break;
+        }
+      node = lf_dlist_link_strip( atomic_load_rlx( &(node->next) ) );
+    }
+}
+
+/*  Unlink [hook], which holds nothing anymore, unless someone else marked */
+/*  it already: its neighbours of back then may be gone by now */
+static void lf_dlist_move_unlink( lf_dlist_t * volatile l, dlist_node_t * volatile hook )
+{
+  if( lf_dlist_mark_deleted( l, hook ) == DL_STATUS_OK )
+    {
+      lf_dlist_unlink_marked( l, hook, atomic_load_acq( &(hook->next) ) );
+    }
+}
+
+/*  Retire the proxy [hook]; its caller reserved the room for it */
+static void lf_dlist_move_retire( lf_dlist_t * volatile l, dlist_node_t * volatile hook )
+{
+  int32_t rc = epoch_retire( (void *)((char *)hook - lf_dlist_proxy_offset( l )), node_pool_free );
+
+  RAW_CHECK( rc == RC_SUCCESS, "no room to retire a proxy" );
+  UNUSE_ARG( rc );
+}
+
+/*  [node] was taken off [holder] (NULL for its own link) by a delete or a */
+/*  pop: unlink and retire what is left of it */
+static void lf_dlist_move_remove( lf_dlist_t   * volatile l,
+                                  dlist_node_t * volatile node,
+                                  dlist_node_t * volatile holder )
+{
+  /*  its own link, also if the mover that moved it away is not done */
+  lf_dlist_move_unlink( l, node );
+  if( holder != NULL )
+    {
+      lf_dlist_move_unlink( l, holder );
+      lf_dlist_move_retire( l, holder );
+    }
+  lf_dlist_index_remove( l, node );
+}
+
+/*  lf_dlist_delete() on a list with moves */
+static DL_STATUS lf_dlist_move_delete( lf_dlist_t * volatile l, dlist_node_t * volatile node )
+{
+  dlist_node_t * holder = NULL;
+
+  /*  room for the proxy and for the entry of a hash index */
+  if( epoch_retire_reserve( 2 ) != RC_SUCCESS )
+    {
+      return DL_STATUS_OUT_OF_MEMORY;
+    }
+
+  lf_dlist_epoch_enter();
+
+  while( true )
+    {
+      holder = atomic_load_acq( &(lf_dlist_move_ref( l, node )->holder) );
+      if( (uint64_t)holder & DL_NODE_DELETED )
+        {
+          lf_dlist_backoff_reset( l );
+          lf_dlist_epoch_exit();
+          return DL_STATUS_NOT_FOUND;
+        }
+
+      if( atomic_cas_ptr( &(lf_dlist_move_ref( l, node )->holder),
+                          holder,
+                          (dlist_node_t *)((uint64_t)holder | DL_NODE_DELETED) ) )
+        {
+          break;
+        }
+
+      lf_dlist_backoff( l );
+    }
+
+  lf_dlist_size_add( l, -1 );
+  lf_dlist_move_remove( l, node, holder );
+  lf_dlist_backoff_reset( l );
+  lf_dlist_epoch_exit();
+
+  return DL_STATUS_OK;
+}
+
+/*  pop_front()/pop_back() on a list with moves: take the first node held */
+/*  from that end */
+static DL_STATUS lf_dlist_move_pop( lf_dlist_t    * volatile l,
+                                    dlist_node_t         ** _node,
+                                    bool                     front )
+{
+  dlist_node_t * start  = ( front == true ) ? l->head : l->tail;
+  dlist_node_t * end    = ( front == true ) ? l->tail : l->head;
+  dlist_node_t * hook   = start;
+  dlist_node_t * node   = NULL;
+  dlist_node_t * holder = NULL;
+
+  *_node = NULL;
+
+  if( epoch_retire_reserve( 2 ) != RC_SUCCESS )
+    {
+      return DL_STATUS_OUT_OF_MEMORY;
+    }
+
+  lf_dlist_epoch_enter();
+
+  while( true )
+    {
+      hook = ( front == true ) ? lf_dlist_next_link( l, hook ) : lf_dlist_prev_link( l, hook );
+      if( hook == NULL || hook == end )
+        {
+          lf_dlist_backoff_reset( l );
+          lf_dlist_epoch_exit();
+          return DL_STATUS_NOT_FOUND;
+        }
+
+      node = lf_dlist_move_entry( l, hook );
+      if( node == NULL )
+        {
+          continue;
+        }
+
+      holder = ( hook == node ) ? NULL : hook;
+      if( atomic_cas_ptr( &(lf_dlist_move_ref( l, node )->holder),
+                          holder,
+                          (dlist_node_t *)((uint64_t)holder | DL_NODE_DELETED) ) )
+        {
+          break;
+        }
+
+      /*  moved or taken meanwhile: start over from the end */
+      hook = start;
+      lf_dlist_backoff( l );
+    }
+
+  lf_dlist_size_add( l, -1 );
+  lf_dlist_move_remove( l, node, holder );
+  lf_dlist_backoff_reset( l );
+  lf_dlist_epoch_exit();
+
+  *_node = node;
+  return DL_STATUS_OK;
+}
+
+/*  The hook of [node] is within DL_MOVE_HOT_DISTANCE links of the end */
+static bool lf_dlist_move_hot( lf_dlist_t   * volatile l,
+                               dlist_node_t * volatile hook,
+                               bool                    to_tail )
+{
+  dlist_node_t * end = ( to_tail == true ) ? l->tail : l->head;
+  int32_t        i   = 0;
+
+  for( i = 0 ; i < DL_MOVE_HOT_DISTANCE && hook != NULL ; i++ )
+    {
+      hook = ( to_tail == true ) ? lf_dlist_next_link( l, hook ) : lf_dlist_prev_link( l, hook );
+      if( hook == end )
+        {
+          return true;
+        }
+    }
+
+  return false;
+}
+
+static DL_STATUS lf_dlist_move( lf_dlist_t   * volatile l,
+                                dlist_node_t * volatile node,
+                                bool                    to_tail )
+{
+  dlist_node_t * holder = NULL;
+  dlist_node_t * hook   = NULL;
+  dlist_node_t * proxy  = NULL;
+  char         * obj    = NULL;
+  DL_STATUS      st     = DL_STATUS_OK;
+
+  RAW_CHECK( node != l->head && node != l->tail, "moving an end of the list" );
+
+  if( l->move_pool == NULL )
+    {
+      return DL_STATUS_NOT_SUPPORTED;
+    }
+
+  /*  the hook left behind may be a proxy to retire: find out now, while */
+  /*  nothing is changed yet */
+  if( epoch_retire_reserve( 1 ) != RC_SUCCESS )
+    {
+      return DL_STATUS_OUT_OF_MEMORY;
+    }
+
+  lf_dlist_epoch_enter();
+
+  holder = atomic_load_acq( &(lf_dlist_move_ref( l, node )->holder) );
+  if( (uint64_t)holder & DL_NODE_DELETED )
+    {
+      st = DL_STATUS_NOT_FOUND;
+      goto label_out;
+    }
+  hook = ( holder != NULL ) ? holder : node;
+
+  /*  1. A hot node stays where it is */
+  if( lf_dlist_move_hot( l, hook, to_tail ) == true )
+    {
+      goto label_out;
+    }
+
+  obj = (char *)node_pool_alloc( l->move_pool );
+  if( obj == NULL )
+    {
+      st = DL_STATUS_OUT_OF_MEMORY;
+      goto label_out;
+    }
+  proxy = (dlist_node_t *)(obj + lf_dlist_proxy_offset( l ));
+  atomic_store_rlx( &(lf_dlist_move_ref( l, proxy )->holder),
+                    (dlist_node_t *)((uint64_t)node | DL_NODE_DIRTY) );
+
+  /*  2. Link the proxy at the end: it holds nothing yet, readers step */
+  /*  over it */
+  if( to_tail == true )
+    {
+      lf_dlist_push_link_back( l, proxy );
+    }
+  else
+    {
+      lf_dlist_push_link_front( l, proxy );
+    }
+
+  /*  3. Hand [node] over to it. If a delete or another move came first, */
+  /*  the proxy is what is left behind. */
+  if( atomic_cas_ptr( &(lf_dlist_move_ref( l, node )->holder), holder, proxy ) == false )
+    {
+      if( (uint64_t)atomic_load_acq( &(lf_dlist_move_ref( l, node )->holder) ) & DL_NODE_DELETED )
+        {
+          st = DL_STATUS_NOT_FOUND;
+        }
+      hook = proxy;
+    }
+
+  /*  4. Unlink what is left behind */
+  lf_dlist_move_unlink( l, hook );
+  if( hook != node )
+    {
+      lf_dlist_move_retire( l, hook );
+    }
+
+label_out:
+  lf_dlist_backoff_reset( l );
+  lf_dlist_epoch_exit();
+
+  return st;
+}
+
+DL_STATUS lf_dlist_move_to_tail( lf_dlist_t * volatile l, dlist_node_t * volatile node )
+{
+  return lf_dlist_move( l, node, true );
+}
+
+DL_STATUS lf_dlist_move_to_head( lf_dlist_t * volatile l, dlist_node_t * volatile node )
+{
+  return lf_dlist_move( l, node, false );
+}
+
+static dlist_node_t * lf_dlist_correct_prev( lf_dlist_t   * volatile l,
+                                             dlist_node_t * volatile _prev,
+                                             dlist_node_t * volatile _node )
+{
+  dlist_node_t * prev = _prev;
+  dlist_node_t * node = _node;
+  dlist_node_t * link1 = NULL;
+  dlist_node_t * last_link = NULL;
+  dlist_node_t * prev_next = NULL;
+  dlist_node_t * desired   = NULL;
+  dlist_node_t * p         = NULL;
+  dlist_node_t * prev_cleared      = NULL;
+  dlist_node_t * prev_cleared_prev = NULL;
+
+  RAW_CHECK( ((uint64_t )node & DL_NODE_DELETED) == 0, "node has deleted mark" );
+  RAW_CHECK( prev, "invalid prev pointer" );
+
+  while( true )
+    {
+      link1 = atomic_load_acq( &(node->prev) );
+      if( (uint64_t)link1 & DL_NODE_DELETED )
+        {
+          break;
+        }
+
+      prev_cleared = (dlist_node_t *)((uint64_t)prev & DL_NODE_DELETED_MASK);
+#if 1
+      if( prev_cleared == NULL )
+        {
+          return NULL;
+        }
+#endif
+
+      prev_next = atomic_load_acq( &(prev_cleared->next) );
+      if( (uint64_t)prev_next & DL_NODE_DELETED )
+        {
+          if( last_link )
+            {
+              lf_dlist_mark_node_pointer( l, &(prev_cleared->prev) );
+
+              desired = (dlist_node_t *)(((uint64_t)prev_next & DL_NODE_DELETED_MASK));
+              (void)lf_dlist_link_cas( &(last_link->next), prev, desired );
+              prev = last_link;
+              last_link = NULL;
+
+              continue;
+            }
+
+          prev_next = atomic_load_acq( &(prev_cleared->prev) );
+          prev = prev_next;
+          RAW_CHECK( prev, "invalid prev pointer" );
+          continue;
+        }
+
+      RAW_CHECK( ((uint64_t )prev_next & DL_NODE_DELETED) == 0,
+                 "invalid next field in predecessor" );
+
+      if( lf_dlist_link_strip( prev_next ) != node )
+        {
+          last_link = prev_cleared;
+          prev = prev_next;
+          continue;
+        }
+
+      p = (dlist_node_t *)(((uint64_t)prev & DL_NODE_DELETED_MASK));
+
+#if 1 // IMPRV_SAFTEY
+      if( p == lf_dlist_link_strip( link1 ) )
+        {
+          break;
+        }
+#endif // IMPRV_SAFTEY
+
+      if( lf_dlist_link_cas( &(node->prev), link1, p ) )
+        {
+          prev_cleared_prev = atomic_load_acq( &(prev_cleared->prev) );
+          if( (uint64_t)prev_cleared_prev & DL_NODE_DELETED )
+            {
+              continue;
+            }
+          break;
+        }
+      lf_dlist_backoff( l );
+    }
+
+  return (dlist_node_t *)prev;
+}
+
+dlist_node_t * lf_dlist_correct_next( lf_dlist_t   * volatile l,
+                                      dlist_node_t * volatile _node )
+{
+  dlist_node_t * node      = _node;
+  dlist_node_t * next      = NULL;
+  dlist_node_t * node_next = NULL;
+  dlist_node_t * next_next = NULL;
+
+  while( node != l->tail )
+    {
+      RAW_CHECK( node, "null current node" );
+      next = lf_dlist_dereference_node_pointer_mem_only( atomic_load_acq( &(node->next) ) );
+      if( next == NULL )
+        {
+          return NULL;
+        }
+
+      next_next = atomic_load_acq( &(next->next) );
+
+      if( (uint64_t)next_next & DL_NODE_DELETED )
+        {
+          /*  But my next pointer isn't pointing the next with the deleted bit set, */
+          /*  so we set the deleted bit in next's prev pointer. */
+          lf_dlist_mark_node_pointer( l, &(next->prev) );
+
+          /*  The next pointer of the node behind me has the deleted mark set */
+          node_next = atomic_load_acq( &(node->next) );
+          if( (uint64_t)lf_dlist_link_strip( node_next ) != ((uint64_t)next | DL_NODE_DELETED) )
+            {
+              /*  Now try to unlink the deleted next node; if someone else */
+              /*  changed [node->next] meanwhile, just re-read it */
+              if( lf_dlist_link_strip( node_next ) == next )
+                {
+                  (void)lf_dlist_link_cas( &(node->next),
+                                           node_next,
+                                           (dlist_node_t *)((uint64_t)next_next & DL_NODE_DELETED_MASK) );
+                }
+              continue;
+            }
+        }
+
+      node = next;
+
+      if( ((uint64_t)next_next & DL_NODE_DELETED) == 0 )
+        {
+          return (dlist_node_t *)next;
+        }
+    }
+
+  return NULL; /*  nothing after tail */
+}
+
+void lf_dlist_backoff( lf_dlist_t * volatile l )
+{
+  backoff_spin( (const volatile void *)l, l->backoff_policy, l->backoff_max );
+}
+
+void lf_dlist_backoff_reset( lf_dlist_t * volatile l )
+{
+  backoff_reset( (const volatile void *)l, l->backoff_policy );
+}
+
+int64_t lf_dlist_size( lf_dlist_t * volatile l )
+{
+  int64_t size = counter_read( (counter_t *)&(l->size) );
+
+  /*  a node may be deleted before its insert has been counted */
+  return ( size < 0 ) ? 0 : size;
+}
+
+int64_t lf_dlist_size_approx( lf_dlist_t * volatile l )
+{
+  int64_t size = counter_read_approx( (counter_t *)&(l->size) );
+
+  return ( size < 0 ) ? 0 : size;
+}
+
+void lf_dlist_set_allocator( lf_dlist_t * volatile l,
+                             lf_dlist_alloc_fn_t    alloc_fn,
+                             lf_dlist_free_fn_t     free_fn,
+                             void                 * ctx )
+{
+  l->alloc_fn  = alloc_fn;
+  l->free_fn   = free_fn;
+  l->alloc_ctx = ctx;
+}
+
+void lf_dlist_set_node_pool( lf_dlist_t * volatile l, node_pool_t * pool )
+{
+  lf_dlist_set_allocator( l, lf_dlist_pool_alloc, node_pool_free, (void *)pool );
+}
+
+void * lf_dlist_node_alloc( lf_dlist_t * volatile l, size_t size )
+{
+  return l->alloc_fn( l->alloc_ctx, size );
+}
+
+void lf_dlist_node_free( lf_dlist_t * volatile l, void * node )
+{
+  l->free_fn( node );
+}
+
+/* ****************************************************************************
+ * Ordered lists and their index
+ */
+
+/*  Address hash of a node (splitmix64 finalizer): the top bits choose the */
+/*  sampled nodes, the low bits the height of their tower */
+static uint64_t lf_dlist_index_hash( dlist_node_t * volatile node )
+{
+  return splitmix64( (uint64_t)node );
+}
+
+static bool lf_dlist_index_sampled( lf_dlist_t * volatile l, uint64_t hash )
+{
+  return ( l->index_shift == 0 || (hash >> (64 - l->index_shift)) == 0 ) ? true : false;
+}
+
+static void lf_dlist_index_add( lf_dlist_t * volatile l, dlist_node_t * volatile node )
+{
+  uint64_t hash    = lf_dlist_index_hash( node );
+  bool     sampled = ( l->index != NULL && lf_dlist_index_sampled( l, hash ) );
+
+  if( l->hash != NULL )
+    {
+      (void)hash_index_add( l->hash, l->key_fn( node ), (void *)node );
+    }
+  else if( sampled == false )
+    {
+      return;
+    }
+
+  if( sampled == true )
+    {
+      (void)skip_index_add( l->index, l->key_fn( node ), (void *)node, hash );
+    }
+
+  /*  [node] may have been deleted before it got indexed: then its deleter */
+  /*  found nothing to remove. Pairs with lf_dlist_index_remove(). */
+  mem_barrier();
+  if( lf_dlist_linked( l, node ) == false )
+    {
+      lf_dlist_index_remove( l, node );
+    }
+}
+
+/*  Index the run just published by insert_chain_*. The walk follows the */
+/*  next pointers, deleted nodes included, so it meets every node of the */
+/*  run that is still linked, and the nodes other threads inserted inside */
+/*  the run meanwhile (indexed twice, which does nothing). If [last] is */
+/*  unlinked already, the walk ends at the tail, stepping over the proxies */
+/*  of lf_dlist_move() on the way. */
+static void lf_dlist_index_add_chain( lf_dlist_t   * volatile l,
+                                      dlist_node_t * volatile first,
+                                      dlist_node_t * volatile last )
+{
+  dlist_node_t * node = first;
+
+  while( true )
+    {
+      if( l->move_pool == NULL || lf_dlist_move_proxy( l, node ) == false )
+        {
+          lf_dlist_index_add( l, node );
+        }
+      if( node == last )
+        {
+          break;
+        }
+
+      node = lf_dlist_dereference_node_pointer_mem_only( atomic_load_acq( &(node->next) ) );
+      if( node == l->tail )
+        {
+          break;
+        }
+    }
+}
+
+/*  Called by whoever marked [node] deleted */
+static void lf_dlist_index_remove( lf_dlist_t * volatile l, dlist_node_t * volatile node )
+{
+  bool sampled = ( l->index != NULL &&
+                   lf_dlist_index_sampled( l, lf_dlist_index_hash( node ) ) );
+
+  if( l->hash == NULL && sampled == false )
+    {
+      return;
+    }
+
+  /*  order the mark before the searches, see lf_dlist_index_add() */
+  mem_barrier();
+  if( l->hash != NULL )
+    {
+      hash_index_remove( l->hash, l->key_fn( node ), (void *)node );
+    }
+  if( sampled == true )
+    {
+      skip_index_remove( l->index, l->key_fn( node ), (void *)node );
+    }
+}
+
+/*  Last live indexed node with a key below [key], or the head */
+static dlist_node_t * lf_dlist_index_floor( lf_dlist_t * volatile l, int64_t key )
+{
+  dlist_node_t * node = NULL;
+  int64_t        entry_key = key;
+
+  while( true )
+    {
+      node = (dlist_node_t *)skip_index_floor( l->index, entry_key, &entry_key );
+      if( node == NULL )
+        {
+          return l->head;
+        }
+
+      /*  the entry of a deleted node is on its way out: its next pointer */
+      /*  may lead to nodes freed already, so try the entry before it */
+      if( lf_dlist_marked_next( node ) == false )
+        {
+          return node;
+        }
+    }
+}
+
+void lf_dlist_set_key_fn( lf_dlist_t * volatile l, lf_dlist_key_fn_t key_fn )
+{
+  l->key_fn = key_fn;
+}
+
+int32_t lf_dlist_index_create( lf_dlist_t * volatile l, uint32_t sample_shift )
+{
+  skip_index_t * index = NULL;
+
+  TRY( l->key_fn == NULL || l->index != NULL || l->move_pool != NULL || sample_shift >= 64 );
+  TRY( skip_index_create( &index ) != RC_SUCCESS );
+
+  l->index_shift = sample_shift;
+  l->index       = index;
+
+  return RC_SUCCESS;
+
+  CATCH_END;
+
+  return RC_FAIL;
+}
+
+void lf_dlist_index_destroy( lf_dlist_t * volatile l )
+{
+  skip_index_destroy( l->index );
+  l->index = NULL;
+}
+
+int32_t lf_dlist_hash_create( lf_dlist_t * volatile l, uint32_t buckets )
+{
+  hash_index_t * hash = NULL;
+
+  TRY( l->key_fn == NULL || l->hash != NULL );
+  TRY( hash_index_create( &hash, buckets ) != RC_SUCCESS );
+
+  l->hash = hash;
+
+  return RC_SUCCESS;
+
+  CATCH_END;
+
+  return RC_FAIL;
+}
+
+void lf_dlist_hash_destroy( lf_dlist_t * volatile l )
+{
+  hash_index_destroy( l->hash );
+  l->hash = NULL;
+}
+
+/*  ordered append: a parked run of the ring. [tag] is (ticket << 1) | 1 */
+/*  while the run waits, ticket << 1 once a publisher took it. */
+typedef struct _lf_dlist_seq_slot lf_dlist_seq_slot_t;
+struct _lf_dlist_seq_slot
+{
+  uint64_t ATOMIC_VAR  tag;
+  uint64_t             cnt;
+  dlist_node_t       * first;
+  dlist_node_t       * last;
+};
+
+struct _lf_dlist_seq
+{
+  uint64_t ATOMIC_VAR  next;       /* next ticket to hand out */
+  char                 pad0[64 - sizeof(uint64_t)];
+  uint64_t ATOMIC_VAR  published;  /* oldest ticket not linked yet */
+  char                 pad1[64 - sizeof(uint64_t)];
+  lf_dlist_seq_slot_t  slot[LF_DLIST_SEQ_RING];
+};
+
+#define lf_dlist_seq_tag( _ticket, _parked ) \
+  (((uint64_t)(_ticket) << 1) | ((_parked) ? 1 : 0))
+
+int32_t lf_dlist_seq_create( lf_dlist_t * volatile l, uint64_t first_ticket )
+{
+  lf_dlist_seq_t * seq = NULL;
+
+  TRY( l->seq != NULL );
+  TRY( posix_memalign( (void **)&seq, 64, sizeof(lf_dlist_seq_t) ) != 0 );
+  memset( (void *)seq, 0x00, sizeof(lf_dlist_seq_t) );
+
+  seq->next      = first_ticket;
+  seq->published = first_ticket;
+  l->seq = seq;
+
+  return RC_SUCCESS;
+
+  CATCH_END;
+
+  return RC_FAIL;
+}
+
+void lf_dlist_seq_destroy( lf_dlist_t * volatile l )
+{
+  free( l->seq );
+  l->seq = NULL;
+}
+
+uint64_t lf_dlist_seq_take( lf_dlist_t * volatile l, uint32_t cnt )
+{
+  return atomic_add_fetch( &(l->seq->next), (uint64_t)cnt ) - cnt;
+}
+
+uint64_t lf_dlist_seq_next( lf_dlist_t * volatile l )
+{
+  return atomic_load_acq( &(l->seq->next) );
+}
+
+uint64_t lf_dlist_seq_published( lf_dlist_t * volatile l )
+{
+  return atomic_load_acq( &(l->seq->published) );
+}
+
+/*  Park the run of [ticket] ([first] NULL: an empty run) and link every */
+/*  parked run that is next in line */
+static DL_STATUS lf_dlist_seq_publish( lf_dlist_t * volatile l,
+                                       uint64_t               ticket,
+                                       uint32_t               cnt,
+                                       dlist_node_t * volatile first,
+                                       dlist_node_t * volatile last )
+{
+  lf_dlist_seq_t      * seq  = l->seq;
+  lf_dlist_seq_slot_t * slot = NULL;
+  uint64_t              published = 0;
+  DL_STATUS             st = DL_STATUS_OK;
+
+  if( seq == NULL || cnt == 0 ||
+      ticket < atomic_load_acq( &(seq->published) ) )
+    {
+      return DL_STATUS_INVALID_ARGUMENT;
+    }
+
+  /*  the slot is free once the run parked LF_DLIST_SEQ_RING tickets */
+  /*  before ours is linked */
+  while( ticket - atomic_load_acq( &(seq->published) ) >= LF_DLIST_SEQ_RING )
+    {
+      lf_dlist_backoff( l );
+    }
+  lf_dlist_backoff_reset( l );
+
+  slot = &(seq->slot[ticket % LF_DLIST_SEQ_RING]);
+  slot->cnt   = cnt;
+  slot->first = first;
+  slot->last  = last;
+  atomic_store_rel( &(slot->tag), lf_dlist_seq_tag( ticket, true ) );
+
+  /*  Park, then look whether it is our turn; the publisher advances */
+  /*  [published], then looks at the slot. With a full barrier on both */
+  /*  sides at least one of the two sees the other, and the CAS on the tag */
+  /*  decides which one links the run. */
+  mem_barrier();
+  published = atomic_load_acq( &(seq->published) );
+
+  while( true )
+    {
+      slot = &(seq->slot[published % LF_DLIST_SEQ_RING]);
+      if( atomic_cas_ptr( &(slot->tag),
+                          lf_dlist_seq_tag( published, true ),
+                          lf_dlist_seq_tag( published, false ) ) == false )
+        {
+          /*  not parked yet (its owner will find it is its turn), or */
+          /*  someone else is on it */
+          break;
+        }
+
+      if( slot->first != NULL )
+        {
+          st = lf_dlist_insert_chain_before( l, l->tail, slot->first, slot->last );
+          if( st != DL_STATUS_OK )
+            {
+              /*  park it again: [published] stays in front of it and */
+              /*  the next append retries */
+              atomic_store_rel( &(slot->tag), lf_dlist_seq_tag( published, true ) );
+              return st;
+            }
+        }
+
+      published += slot->cnt;
+      atomic_store_rel( &(seq->published), published );
+      mem_barrier();
+    }
+
+  return DL_STATUS_OK;
+}
+
+DL_STATUS lf_dlist_seq_append( lf_dlist_t * volatile l,
+                               uint64_t               ticket,
+                               uint32_t               cnt,
+                               dlist_node_t * volatile first,
+                               dlist_node_t * volatile last )
+{
+  if( first == NULL || last == NULL )
+    {
+      return DL_STATUS_INVALID_ARGUMENT;
+    }
+
+  return lf_dlist_seq_publish( l, ticket, cnt, first, last );
+}
+
+DL_STATUS lf_dlist_seq_cancel( lf_dlist_t * volatile l,
+                               uint64_t               ticket,
+                               uint32_t               cnt )
+{
+  return lf_dlist_seq_publish( l, ticket, cnt, NULL, NULL );
+}
+
+/*  combining tail: the slot of a thread slot. [first] is set by the owner */
+/*  to post a run and cleared by the combiner once the run is linked; the */
+/*  counters are the owner's only, until it flushes them into the list's */
+/*  window. */
+typedef struct _lf_dlist_fc_slot lf_dlist_fc_slot_t;
+struct _lf_dlist_fc_slot
+{
+  dlist_node_t * ATOMIC_VAR  first;
+  dlist_node_t             * last;
+  uint32_t                   appends;  /* CAS mode appends not flushed yet */
+  uint32_t                   fails;    /* and their failed CASes */
+} __attribute__((aligned(64)));
+
+/*  CAS mode appends in the upper half of the window word, failed CASes */
+/*  in the lower half */
+#define lf_dlist_fc_win( _appends, _fails ) \
+  (((uint64_t)(_appends) << 32) | (uint64_t)(_fails))
+#define lf_dlist_fc_win_appends( _win )  ((uint32_t)((_win) >> 32))
+#define lf_dlist_fc_win_fails( _win )    ((uint32_t)(_win))
+
+struct _lf_dlist_fc
+{
+  uint64_t ATOMIC_VAR  combining;  /* 1: flat combining, 0: CAS */
+  uint64_t ATOMIC_VAR  switches;
+  /*  thresholds, see lf_dlist_fc_tune() */
+  uint32_t             window;
+  uint32_t             hot_fails;
+  uint32_t             cold_batch;
+  char                 pad0[64 - 2 * sizeof(uint64_t) - 3 * sizeof(uint32_t)];
+  /*  the CAS mode window of the whole list */
+  uint64_t ATOMIC_VAR  cas_window;
+  char                 pad1[64 - sizeof(uint64_t)];
+  uint64_t ATOMIC_VAR  lock;       /* 1 while a combiner runs */
+  /*  combiner only: passes and runs of the window */
+  uint32_t             passes;
+  uint32_t             runs;
+  char                 pad2[64 - sizeof(uint64_t) - 2 * sizeof(uint32_t)];
+  lf_dlist_fc_slot_t   slot[LF_DLIST_FC_SLOTS];
+};
+
+int32_t lf_dlist_fc_create( lf_dlist_t * volatile l )
+{
+  lf_dlist_fc_t * fc = NULL;
 
-              continue;
-            }
+  TRY( l->fc != NULL );
+  TRY( posix_memalign( (void **)&fc, 64, sizeof(lf_dlist_fc_t) ) != 0 );
+  memset( (void *)fc, 0x00, sizeof(lf_dlist_fc_t) );
+  fc->window     = LF_DLIST_FC_WINDOW;
+  fc->hot_fails  = LF_DLIST_FC_HOT_FAILS;
+  fc->cold_batch = LF_DLIST_FC_COLD_BATCH;
 
-          mem_barrier();
-          prev_next = prev_cleared->prev;
-          prev = prev_next;
-          RAW_CHECK( prev, "invalid prev pointer" );
-          continue;
-        }
+  l->fc = fc;
 
-      RAW_CHECK( ((uint64_t )prev_next & DL_NODE_DELETED) == 0,
-                 "invalid next field in predecessor" );
+  return RC_SUCCESS;
+
+  CATCH_END;
+
+  return RC_FAIL;
+}
+
+int32_t lf_dlist_fc_tune( lf_dlist_t * volatile l,
+                          uint32_t               window,
+                          uint32_t               hot_fails,
+                          uint32_t               cold_batch )
+{
+  TRY( l->fc == NULL || window == 0 );
+
+  l->fc->window     = window;
+  l->fc->hot_fails  = hot_fails;
+  l->fc->cold_batch = cold_batch;
+
+  return RC_SUCCESS;
+
+  CATCH_END;
+
+  return RC_FAIL;
+}
+
+void lf_dlist_fc_destroy( lf_dlist_t * volatile l )
+{
+  free( l->fc );
+  l->fc = NULL;
+}
+
+bool lf_dlist_fc_combining( lf_dlist_t * volatile l )
+{
+  return ( atomic_load_rlx( &(l->fc->combining) ) != 0 ) ? true : false;
+}
 
-      if( prev_next != node )
+uint64_t lf_dlist_fc_switches( lf_dlist_t * volatile l )
+{
+  return atomic_load_rlx( &(l->fc->switches) );
+}
+
+static void lf_dlist_fc_switch( lf_dlist_fc_t * fc, uint64_t combining )
+{
+  if( atomic_cas_ptr( &(fc->combining), 1 - combining, combining ) )
+    {
+      atomic_fetch_inc( &(fc->switches) );
+    }
+}
+
+/*  One combining pass, with the combiner flag held: chain the posted runs */
+/*  into one, link it, then clear their slots */
+static void lf_dlist_fc_combine( lf_dlist_t * volatile l, lf_dlist_fc_t * fc )
+{
+  dlist_node_t * first = NULL;
+  dlist_node_t * last  = NULL;
+  dlist_node_t * run   = NULL;
+  int32_t        taken[LF_DLIST_FC_SLOTS];
+  int32_t        taken_cnt = 0;
+  int32_t        slot_cnt  = thread_slot_high_water();
+  int32_t        i = 0;
+  DL_STATUS      st = DL_STATUS_OK;
+
+  if( slot_cnt > LF_DLIST_FC_SLOTS )
+    {
+      slot_cnt = LF_DLIST_FC_SLOTS;
+    }
+
+  for( i = 0 ; i < slot_cnt ; i++ )
+    {
+      run = atomic_load_acq( &(fc->slot[i].first) );
+      if( run == NULL )
         {
-          last_link = prev_cleared;
-          mem_barrier();
-          prev = prev_next;
           continue;
         }
 
-      p = (dlist_node_t * volatile)(((uint64_t)prev & DL_NODE_DELETED_MASK));
-
-#if 1 // IMPRV_SAFTEY
-      if( p == link1 )
+      /*  the runs are private until the insert below publishes them */
+      if( last == NULL )
         {
-          break;
+          first = run;
         }
-#endif // IMPRV_SAFTEY
-
-      if( link1 == atomic_cas_64( &node->prev, link1, p ) )
+      else
         {
-          mem_barrier();
-          prev_cleared_prev = prev_cleared->prev;
-          if( (uint64_t)prev_cleared_prev & DL_NODE_DELETED )
-            {
-              continue;
-            }
-          break;
+          lf_dlist_link_store( &(last->next), run );
+          lf_dlist_link_store( &(run->prev), last );
         }
-      lf_dlist_backoff( l );
+      last = fc->slot[i].last;
+      taken[taken_cnt++] = i;
     }
 
-  return (dlist_node_t *)prev;
+  if( taken_cnt == 0 )
+    {
+      return;
+    }
+
+  st = lf_dlist_insert_chain_before( l, l->tail, first, last );
+  RAW_CHECK( st == DL_STATUS_OK, "combined append failed" );
+  UNUSE_ARG( st );
+
+  for( i = 0 ; i < taken_cnt ; i++ )
+    {
+      atomic_store_rel( &(fc->slot[taken[i]].first), NULL );
+    }
+
+  fc->runs += (uint32_t)taken_cnt;
+  if( ++fc->passes >= fc->window )
+    {
+      if( (uint64_t)fc->runs < (uint64_t)fc->window * fc->cold_batch )
+        {
+          /*  hardly anybody to combine with any more */
+          lf_dlist_fc_switch( fc, 0 );
+        }
+      fc->passes = 0;
+      fc->runs   = 0;
+    }
 }
 
-dlist_node_t * lf_dlist_correct_next( lf_dlist_t   * volatile l,
-                                      dlist_node_t * volatile _node )
+/*  Add the counts of [slot] to the window of the list. The flush that */
+/*  fills the window judges it and takes its counts out again, so the */
+/*  next window starts with what was flushed meanwhile. */
+static void lf_dlist_fc_flush( lf_dlist_fc_t * fc, lf_dlist_fc_slot_t * slot )
 {
-  dlist_node_t * volatile node      = _node;
-  dlist_node_t * volatile next      = NULL;
-  dlist_node_t * volatile node_next = NULL;
-  dlist_node_t * volatile next_next = NULL;
+  uint64_t add = lf_dlist_fc_win( slot->appends, slot->fails );
+  uint64_t win = 0;
 
-  while( node != l->tail )
+  slot->appends = 0;
+  slot->fails   = 0;
+
+  win = atomic_add_fetch( &(fc->cas_window), add );
+  if( lf_dlist_fc_win_appends( win ) >= fc->window &&
+      lf_dlist_fc_win_appends( win - add ) < fc->window )
     {
-      RAW_CHECK( node, "null current node" );
-      mem_barrier();
-      next = lf_dlist_dereference_node_pointer_mem_only( node->next );
-      if( next == NULL )
+      (void)atomic_add_fetch( &(fc->cas_window), (uint64_t)0 - win );
+      if( lf_dlist_fc_win_fails( win ) >= fc->hot_fails )
         {
-          return NULL;
+          lf_dlist_fc_switch( fc, 1 );
         }
+    }
+}
 
-      mem_barrier();
-      next_next = next->next;
+DL_STATUS lf_dlist_fc_append( lf_dlist_t * volatile l,
+                              dlist_node_t * volatile first,
+                              dlist_node_t * volatile last )
+{
+  lf_dlist_fc_t      * fc   = l->fc;
+  lf_dlist_fc_slot_t * slot = NULL;
+  int32_t              id   = thread_slot_id();
+  DL_STATUS            st   = DL_STATUS_OK;
 
-      if( (uint64_t)next_next & DL_NODE_DELETED )
+  if( fc == NULL || first == NULL || last == NULL )
+    {
+      return DL_STATUS_INVALID_ARGUMENT;
+    }
+
+  if( id < 0 || id >= LF_DLIST_FC_SLOTS )
+    {
+      return lf_dlist_insert_chain_before( l, l->tail, first, last );
+    }
+
+  slot = &(fc->slot[id]);
+
+  if( atomic_load_rlx( &(fc->combining) ) == 0 )
+    {
+      st = lf_dlist_link_chain_before( l, l->tail, first, last, &(slot->fails) );
+
+      if( ++slot->appends >= LF_DLIST_FC_FLUSH )
         {
-          /*  But my next pointer isn't pointing the next with the deleted bit set, */
-          /*  so we set the deleted bit in next's prev pointer. */
-          lf_dlist_mark_node_pointer( l, (dlist_node_t **volatile)&(next->prev) );
+          lf_dlist_fc_flush( fc, slot );
+        }
 
-          mem_barrier();
-          /*  The next pointer of the node behind me has the deleted mark set */
-          node_next = node->next;
-          if( (uint64_t)node_next != ((uint64_t)next | DL_NODE_DELETED) )
-            {
-              /*  Now try to unlink the deleted next node */
-              while( next !=
-                     atomic_cas_64( &(node->next),
-                                    next,
-                                    (dlist_node_t * volatile)((uint64_t)next_next & DL_NODE_DELETED_MASK) ));
-                {
-                  break;
-                }
-              continue;
-            }
+      return st;
+    }
+
+  /*  post the run; the release store publishes [last] with it */
+  slot->last = last;
+  atomic_store_rel( &(slot->first), first );
+
+  while( atomic_load_acq( &(slot->first) ) != NULL )
+    {
+      if( atomic_load_rlx( &(fc->lock) ) == 0 &&
+          atomic_cas_ptr( &(fc->lock), (uint64_t)0, (uint64_t)1 ) )
+        {
+          lf_dlist_fc_combine( l, fc );
+          atomic_store_rel( &(fc->lock), 0 );
         }
+      else
+        {
+          lf_dlist_backoff( l );
+        }
+    }
+  lf_dlist_backoff_reset( l );
 
-      node = next;
+  return DL_STATUS_OK;
+}
 
-      mem_barrier();
+dlist_node_t * lf_dlist_lower_bound( lf_dlist_t * volatile l, int64_t key )
+{
+  dlist_node_t * node = l->head;
 
-      if( ((uint64_t)next_next & DL_NODE_DELETED) == 0 )
+  RAW_CHECK( l->key_fn, "no key function on the list" );
+
+  lf_dlist_epoch_enter();
+
+  if( l->index != NULL )
+    {
+      node = lf_dlist_index_floor( l, key );
+    }
+
+  while( true )
+    {
+      node = lf_dlist_get_next( l, node );
+      if( node == NULL || node == l->tail )
         {
-          return (dlist_node_t *)next;
+          node = NULL;
+          break;
+        }
+
+      if( l->key_fn( node ) >= key )
+        {
+          break;
         }
     }
 
-  return NULL; /*  nothing after tail */
+  lf_dlist_epoch_exit();
+
+  return node;
 }
 
-void lf_dlist_backoff( lf_dlist_t * volatile l )
+dlist_node_t * lf_dlist_find( lf_dlist_t * volatile l, int64_t key )
 {
-  volatile uint64_t loops = (uint64_t)RNG_generate( (RNG *)(l->rng) );
-  mem_barrier();
-  while( loops-- )
+  dlist_node_t * node = NULL;
+
+  if( l->hash != NULL )
     {
-      mem_barrier();
-      /* do nothing */
+      lf_dlist_epoch_enter();
+      node = (dlist_node_t *)hash_index_lookup( l->hash, key );
+      if( node != NULL && lf_dlist_linked( l, node ) == false )
+        {
+          /*  deleted, its entry is on its way out */
+          node = NULL;
+        }
+      lf_dlist_epoch_exit();
+
+      return node;
+    }
+
+  node = lf_dlist_lower_bound( l, key );
+
+  if( node != NULL && l->key_fn( node ) != key )
+    {
+      return NULL;
     }
+
+  return node;
 }
 
-void lf_dlist_mark_node_pointer( lf_dlist_t * volatile l, dlist_node_t ** volatile _node )
+void lf_dlist_epoch_enter( void )
 {
-  dlist_node_t ** volatile node = _node;
-  dlist_node_t * volatile node_ptr = NULL;
+  epoch_enter();
+}
+
+void lf_dlist_epoch_exit( void )
+{
+  epoch_exit();
+}
+
+void lf_dlist_epoch_barrier( void )
+{
+  epoch_barrier();
+}
+
+int32_t lf_dlist_retire( dlist_node_t * volatile node, lf_dlist_free_fn_t free_fn )
+{
+  RAW_CHECK( lf_dlist_marked_next( node ), "retiring a node that is not deleted" );
+
+  return epoch_retire( (void *)node, free_fn );
+}
+
+int32_t lf_dlist_retire_node( lf_dlist_t * volatile l, void * node )
+{
+  return lf_dlist_retire( (dlist_node_t *)node, l->free_fn );
+}
+
+void lf_dlist_mark_node_pointer( lf_dlist_t * volatile l, dlist_link_t * _node )
+{
+  (void)lf_dlist_mark_link( l, _node );
+}
+
+/*  Set the deleted bit on [link]; true if this call set it */
+static bool lf_dlist_mark_link( lf_dlist_t * volatile l, dlist_link_t * link )
+{
+  dlist_node_t * node_ptr = NULL;
   uint64_t flags = DL_NODE_DELETED;
 
+  UNUSE_ARG( l );
+
   while( true )
     {
-      mem_barrier();
-      node_ptr = *node;
+      node_ptr = atomic_load_acq( link );
 
       RAW_CHECK( node_ptr != l->head->next,
                  "cannot mark head node's next pointer" );
 
-      if( ((uint64_t)node_ptr & DL_NODE_DELETED) ||
-          ( node_ptr == atomic_cas_64( node,
-                                       node_ptr,
-                                       (dlist_node_t * volatile)((uint64_t)node_ptr | flags) ) ) )
+      if( (uint64_t)node_ptr & DL_NODE_DELETED )
         {
-          break;
+          return false;
+        }
+
+      if( lf_dlist_link_cas( link,
+                             node_ptr,
+                             (dlist_node_t *)((uint64_t)node_ptr | flags) ) )
+        {
+          return true;
         }
     }
 }
@@ -635,21 +2550,30 @@ static void lf_dlist_unmark_node_pointer( lf_dlist_t * volatile l,
 
 /*  Extract the real underlying node (masking out the MSB and flush if needed) */
 dlist_node_t * lf_dlist_dereference_node_pointer( lf_dlist_t     * volatile l,
-                                                  dlist_node_t  ** volatile node )
+                                                  dlist_link_t   * node )
 {
-  return (dlist_node_t *)((uint64_t)(*node) & DL_NODE_DELETED_MASK);
+  return (dlist_node_t *)((uint64_t)atomic_load_acq( node ) & DL_NODE_DELETED_MASK);
 }
 
 bool lf_dlist_marked_next( dlist_node_t * volatile node )
 {
-  mem_barrier();
-  return ((((uint64_t)(node->next)) & DL_NODE_DELETED) ? true : false);
+  return ((((uint64_t)atomic_load_acq( &(node->next) )) & DL_NODE_DELETED) ? true : false);
 }
 
 bool lf_dlist_marked_prev( dlist_node_t * volatile node )
 {
-  mem_barrier();
-  return ((((uint64_t)(node->prev)) & DL_NODE_DELETED) ? true : false);
+  return ((((uint64_t)atomic_load_acq( &(node->prev) )) & DL_NODE_DELETED) ? true : false);
+}
+
+bool lf_dlist_linked( lf_dlist_t * volatile l, dlist_node_t * volatile node )
+{
+  if( l->move_pool != NULL )
+    {
+      return ( ((uint64_t)atomic_load_acq( &(lf_dlist_move_ref( l, node )->holder) ) &
+                DL_NODE_DELETED) == 0 ) ? true : false;
+    }
+
+  return ( lf_dlist_marked_next( node ) == false ) ? true : false;
 }
 
 
@@ -663,13 +2587,23 @@ int32_t dlist_cursor_open( dlist_cursor_t    * volatile c,
 {
   TRY( c == NULL || l == NULL );
 
+  c->hazard[0] = epoch_hazard_alloc();
+  c->hazard[1] = ( c->hazard[0] >= 0 ) ? epoch_hazard_alloc() : -1;
+  if( c->hazard[1] < 0 )
+    {
+      /*  out of hazard slots: the cursor reads nodes until it is closed */
+      epoch_hazard_release( c->hazard[0] );
+      c->hazard[0] = -1;
+      lf_dlist_epoch_enter();
+    }
+
   c->l = l;
   c->head = l->head;
   c->tail = l->tail;
+  c->last_node = NULL;
 
   c->dir = dir;
 
-  mem_barrier();
   if( dir == DL_CURSOR_DIR_FORWARD )
     {
       c->cur_node = c->head;
@@ -688,13 +2622,26 @@ int32_t dlist_cursor_open( dlist_cursor_t    * volatile c,
 
 void dlist_cursor_close( dlist_cursor_t * volatile c )
 {
-  if( c != NULL )
+  if( c != NULL && c->l != NULL )
     {
+      if( c->hazard[0] >= 0 )
+        {
+          epoch_hazard_release( c->hazard[0] );
+          epoch_hazard_release( c->hazard[1] );
+          c->hazard[0] = -1;
+          c->hazard[1] = -1;
+        }
+      else
+        {
+          lf_dlist_epoch_exit();
+        }
+
       c->l = NULL;
       c->head = NULL;
       c->tail = NULL;
 
       c->cur_node = NULL;
+      c->last_node = NULL;
 
       c->dir = DL_CURSOR_DIR_NONE;
     }
@@ -702,9 +2649,23 @@ void dlist_cursor_close( dlist_cursor_t * volatile c )
 
 void dlist_cursor_reset( dlist_cursor_t * volatile c )
 {
-  if( c != NULL )
+  if( c != NULL && c->l != NULL )
     {
-      mem_barrier();
+      if( c->hazard[0] >= 0 )
+        {
+          epoch_hazard_set( c->hazard[0], NULL );
+          epoch_hazard_set( c->hazard[1], NULL );
+        }
+      else
+        {
+          /*  back on head or tail the cursor holds no node: if this is the */
+          /*  outermost critical section, let the epoch advance */
+          lf_dlist_epoch_exit();
+          lf_dlist_epoch_enter();
+        }
+
+      c->last_node = NULL;
+
       if( c->dir == DL_CURSOR_DIR_FORWARD )
         {
           c->cur_node = c->head;
@@ -716,17 +2677,78 @@ void dlist_cursor_reset( dlist_cursor_t * volatile c )
     }
 }
 
+void dlist_cursor_seek( dlist_cursor_t * volatile c, dlist_node_t * node )
+{
+  if( c->hazard[0] >= 0 )
+    {
+      /*  the caller protects [node] until we return */
+      epoch_hazard_set( c->hazard[1], (void *)node );
+      epoch_hazard_set( c->hazard[0], (void *)node );
+    }
+
+  c->last_node = node;
+  c->cur_node  = node;
+}
+
+/*  Move the cursor one live node in [dir] */
+static dlist_node_t * dlist_cursor_move( dlist_cursor_t     * volatile c,
+                                         dlist_cursor_dir_t   dir )
+{
+  dlist_node_t * from = c->cur_node;
+  dlist_node_t * to   = NULL;
+  bool           use_hazard = ( c->hazard[0] >= 0 ) ? true : false;
+
+  if( use_hazard == true )
+    {
+      lf_dlist_epoch_enter();
+
+      if( from != NULL && from != c->head && from != c->tail &&
+          lf_dlist_linked( c->l, from ) == false )
+        {
+          /*  [from] was deleted while we were outside of the epoch: its */
+          /*  frozen links may point to nodes freed since, don't follow them */
+          from = c->last_node;
+          if( from == NULL || lf_dlist_linked( c->l, from ) == false )
+            {
+              from = ( dir == DL_CURSOR_DIR_FORWARD ) ? c->head : c->tail;
+            }
+          else if( c->dir != dir )
+            {
+              /*  turning around: [last_node] is the next one in [dir] */
+              to = from;
+              from = c->cur_node;
+            }
+        }
+    }
+
+  if( to == NULL )
+    {
+      to = ( dir == DL_CURSOR_DIR_FORWARD ) ? lf_dlist_get_next( c->l, from )
+                                            : lf_dlist_get_prev( c->l, from );
+    }
+
+  if( use_hazard == true )
+    {
+      /*  both are protected by the epoch until we leave it */
+      epoch_hazard_set( c->hazard[1], (void *)from );
+      epoch_hazard_set( c->hazard[0], (void *)to );
+      lf_dlist_epoch_exit();
+    }
+
+  c->dir       = dir;
+  c->last_node = from;
+  c->cur_node  = to;
+
+  return (dlist_node_t *)to;
+}
+
 dlist_node_t * dlist_cursor_next( dlist_cursor_t * volatile c )
 {
 #ifdef DEBUG
   TRY( c == NULL );
 #endif
 
-  c->dir = DL_CURSOR_DIR_FORWARD;
-  mem_barrier();
-  c->cur_node = lf_dlist_get_next( c->l, c->cur_node );
-
-  return (dlist_node_t *)c->cur_node;
+  return dlist_cursor_move( c, DL_CURSOR_DIR_FORWARD );
 
 #ifdef DEBUG
   CATCH_END;
@@ -740,11 +2762,8 @@ dlist_node_t * dlist_cursor_prev( dlist_cursor_t * volatile c )
 #ifdef DEBUG
   TRY( c == NULL );
 #endif
-  c->dir = DL_CURSOR_DIR_BACKWARD;
-  mem_barrier();
-  c->cur_node = lf_dlist_get_prev( c->l, c->cur_node );
 
-  return (dlist_node_t *)c->cur_node;
+  return dlist_cursor_move( c, DL_CURSOR_DIR_BACKWARD );
 
 #ifdef DEBUG
   CATCH_END;
@@ -753,6 +2772,70 @@ dlist_node_t * dlist_cursor_prev( dlist_cursor_t * volatile c )
 #endif
 }
 
+DL_STATUS dlist_cursor_remove( dlist_cursor_t * volatile c )
+{
+  dlist_node_t * node = c->cur_node;
+  dlist_node_t * succ = NULL;
+  DL_STATUS      st   = DL_STATUS_OK;
+
+  if( node == NULL || node == c->head || node == c->tail )
+    {
+      return DL_STATUS_INVALID_ARGUMENT;
+    }
+
+  lf_dlist_epoch_enter();
+
+  /*  [node] is held by the cursor: its frozen links can be followed inside */
+  /*  this critical section. [last_node] stays behind the successor, and */
+  /*  its hazard pointer as it is. */
+  st = lf_dlist_delete_node( c->l, node );
+  succ = ( c->dir == DL_CURSOR_DIR_BACKWARD ) ? lf_dlist_get_prev( c->l, node )
+                                              : lf_dlist_get_next( c->l, node );
+  if( c->hazard[0] >= 0 )
+    {
+      epoch_hazard_set( c->hazard[0], (void *)succ );
+    }
+  c->cur_node = succ;
+
+  lf_dlist_epoch_exit();
+
+  return st;
+}
+
+int64_t dlist_cursor_erase_if( dlist_cursor_t * volatile c,
+                               dlist_pred_fn_t           pred,
+                               dlist_erase_fn_t          erased,
+                               void                    * ctx )
+{
+  dlist_node_t * node = NULL;
+  int64_t        cnt  = 0;
+  bool           backward = ( c->dir == DL_CURSOR_DIR_BACKWARD ) ? true : false;
+
+  node = ( backward == true ) ? dlist_cursor_prev( c ) : dlist_cursor_next( c );
+  while( node != NULL && dlist_cursor_is_eol( c ) == false )
+    {
+      if( pred( node, ctx ) == true )
+        {
+          if( dlist_cursor_remove( c ) == DL_STATUS_OK )
+            {
+              cnt++;
+              if( erased != NULL )
+                {
+                  erased( node, ctx );
+                }
+            }
+
+          /*  already on the successor, not tested yet */
+          node = c->cur_node;
+          continue;
+        }
+
+      node = ( backward == true ) ? dlist_cursor_prev( c ) : dlist_cursor_next( c );
+    }
+
+  return cnt;
+}
+
 bool dlist_cursor_is_eol( dlist_cursor_t * volatile c )
 {
   bool ret = false;
@@ -4,15 +4,25 @@
 #define _DOUBLEY_LINKED_LIST_H_ 1
 
 #include <stdint.h>
+#include <stddef.h>
 #include "util.h"
-#include "rand_r.h"
+#include "atomic.h"
+#include "backoff.h"
+#include "epoch.h"
+#include "node_pool.h"
+#include "counter.h"
+#include "skip_index.h"
+#include "hash_index.h"
 
-typedef volatile struct _dlist_node _dlist_node_t;
-#define dlist_node_t volatile _dlist_node_t
+/* A link (prev/next) is read and written through the accessors of atomic.h,
+ * see ATOMIC_VAR/ATOMIC_VOLATILE there for the engine-specific qualifiers. */
+typedef ATOMIC_VOLATILE struct _dlist_node _dlist_node_t;
+#define dlist_node_t ATOMIC_VOLATILE _dlist_node_t
+#define dlist_link_t dlist_node_t * ATOMIC_VAR
 struct _dlist_node
 {
-  dlist_node_t * volatile prev; /*  8-byte */
-  dlist_node_t * volatile next; /*  8-byte */
+  dlist_link_t prev; /*  8-byte */
+  dlist_link_t next; /*  8-byte */
 };
 
 typedef int32_t DL_STATUS;
@@ -48,50 +58,408 @@ enum _dl_status
  * HP-UX의 메모리 모델  때문. */
 static const uint64_t DL_NODE_DIRTY         = ((uint64_t)0x0000000000000001); // ((uint64_t)1 << 0)
 static const uint64_t DL_NODE_DELETED       = ((uint64_t)0x0000000000000002); // ((uint64_t)1 << 1)
+#ifdef DL_VERSIONED_LINKS
+/*  Versioned links (`make LINK=versioned`): user space addresses fit in the */
+/*  lower 48 bits, the upper 16 bits of every prev/next link count the */
+/*  updates of that link. Each CAS on a link bumps the version of the value */
+/*  it was given as expected, so a link that went A -> B -> A meanwhile */
+/*  (a node removed, reclaimed and reinserted at the same place) fails the */
+/*  CAS instead of silently succeeding. The mask also strips the version. */
+#define DL_LINK_VERSION_SHIFT  48
+#define DL_LINK_MODE_NAME      "versioned"
+static const uint64_t DL_LINK_VERSION_MASK  = ((uint64_t)0xFFFF000000000000);
+static const uint64_t DL_NODE_DELETED_MASK  = ((uint64_t)0x0000FFFFFFFFFFFD);
+#else
+#define DL_LINK_MODE_NAME      "plain"
+static const uint64_t DL_LINK_VERSION_MASK  = ((uint64_t)0x0000000000000000);
 static const uint64_t DL_NODE_DELETED_MASK  = ((uint64_t)0xFFFFFFFFFFFFFFFD);
+#endif
 
-typedef volatile struct _lock_free_doubly_linked_list volatile _lf_dlist_t;
-#define lf_dlist_t volatile _lf_dlist_t
+/*  Link value without its version: node pointer and mark bits, to compare */
+/*  a loaded link with a node or a marked node */
+#define lf_dlist_link_strip( _link ) \
+  ((dlist_node_t *)((uint64_t)(_link) & ~DL_LINK_VERSION_MASK))
+
+/*  Node allocator of a list: the library never allocates nodes by itself, */
+/*  users go through lf_dlist_node_alloc()/lf_dlist_node_free() and */
+/*  lf_dlist_retire_node() so that the allocator is chosen per list. */
+/*  [alloc_fn] returns zero-filled memory of [size] bytes or NULL. */
+typedef void * (*lf_dlist_alloc_fn_t)( void * ctx, size_t size );
+typedef epoch_free_fn_t lf_dlist_free_fn_t;
+
+/*  Key of a node, for ordered lists: keys never decrease from head to tail */
+/*  and do not change while the node is linked. */
+typedef int64_t (*lf_dlist_key_fn_t)( dlist_node_t * node );
+
+/*  Sequencer of the ordered append mode, see lf_dlist_seq_create() */
+typedef struct _lf_dlist_seq lf_dlist_seq_t;
+/*  Publication array of the combining tail, see lf_dlist_fc_create() */
+typedef struct _lf_dlist_fc lf_dlist_fc_t;
+
+typedef ATOMIC_VOLATILE struct _lock_free_doubly_linked_list ATOMIC_VOLATILE _lf_dlist_t;
+#define lf_dlist_t ATOMIC_VOLATILE _lf_dlist_t
 struct _lock_free_doubly_linked_list
 {
-  dlist_node_t * volatile head;
-  dlist_node_t * volatile tail;
-  /*  A random number generator for back off loop count */
-  RNG rng[1];
+  dlist_node_t * ATOMIC_VOLATILE head;
+  dlist_node_t * ATOMIC_VOLATILE tail;
+  /*  Back off policy and its maximum loop count; read-only after */
+  /*  initialization, the per-thread state of each list lives in backoff.c */
+  backoff_policy_t backoff_policy;
+  uint32_t         backoff_max;
+  /*  Node allocator, calloc()/free() unless lf_dlist_set_allocator() */
+  lf_dlist_alloc_fn_t alloc_fn;
+  lf_dlist_free_fn_t  free_fn;
+  void              * alloc_ctx;
+  /*  Live nodes: + on insert/push, - by whoever marks a node deleted */
+  counter_t           size;
+  /*  Ordered lists only: key of a node, and the optional index over */
+  /*  1 in 2^index_shift of the nodes (lf_dlist_index_create()) */
+  lf_dlist_key_fn_t   key_fn;
+  skip_index_t      * index;
+  uint32_t            index_shift;
+  /*  Ordered or not: hash index of every inserted node by key */
+  /*  (lf_dlist_hash_create()) */
+  hash_index_t      * hash;
+  /*  Ordered append mode (lf_dlist_seq_create()) */
+  lf_dlist_seq_t    * seq;
+  /*  Adaptive combining tail (lf_dlist_fc_create()) */
+  lf_dlist_fc_t     * fc;
+  /*  Moves (lf_dlist_move_create()): pool of the proxies standing in for */
+  /*  moved nodes, and where a node keeps its lf_dlist_move_ref_t */
+  node_pool_t       * move_pool;
+  ptrdiff_t           move_ref_offset;
 };
 
 int32_t lf_dlist_initiaize( lf_dlist_t    * volatile l,
                             dlist_node_t  * volatile head,
                             dlist_node_t  * volatile tail,
+                            backoff_policy_t backoff_policy,
                             int32_t backoff_cnt_max );
 void lf_dlist_finalize( lf_dlist_t * volatile l );
 
+/*  A list with its own head and tail, on cache lines no other lane shares: */
+/*  the parts of the lists made of several (striped_dlist.h, */
+/*  relaxed_dlist.h). lf_dlist_lanes_create() allocates and initializes */
+/*  [cnt] of them, lf_dlist_lanes_destroy() finalizes and frees them. */
+typedef struct _lf_dlist_lane lf_dlist_lane_t;
+struct _lf_dlist_lane
+{
+  lf_dlist_t    list[1];
+  dlist_node_t  head[1];
+  dlist_node_t  tail[1];
+} __attribute__((aligned(64)));
+
+int32_t lf_dlist_lanes_create( lf_dlist_lane_t ** lanes,
+                               uint32_t           cnt,
+                               backoff_policy_t   backoff_policy,
+                               int32_t            backoff_cnt_max );
+void lf_dlist_lanes_destroy( lf_dlist_lane_t * lanes, uint32_t cnt );
+
 /*  Verify the links between each pair of nodes (including head and tail). */
 /*  For single-threaded cases only, no CC whatsoever. */
 void lf_dlist_single_thread_sanity_check( lf_dlist_t * volatile l );
 void lf_dlist_backoff( lf_dlist_t * volatile l );
+void lf_dlist_backoff_reset( lf_dlist_t * volatile l );
+
+/*  Number of nodes in the list, head and tail excluded. lf_dlist_size() is */
+/*  exact once the operations in flight are done; lf_dlist_size_approx() */
+/*  may lag by a fraction of a millisecond and is the one to poll. */
+int64_t lf_dlist_size( lf_dlist_t * volatile l );
+int64_t lf_dlist_size_approx( lf_dlist_t * volatile l );
+
+/*  Set the node allocator before the list is shared */
+void lf_dlist_set_allocator( lf_dlist_t * volatile l,
+                             lf_dlist_alloc_fn_t    alloc_fn,
+                             lf_dlist_free_fn_t     free_fn,
+                             void                 * ctx );
+/*  Allocate nodes from [pool] (node_pool.h); nodes up to its object size */
+void lf_dlist_set_node_pool( lf_dlist_t * volatile l, node_pool_t * pool );
+void * lf_dlist_node_alloc( lf_dlist_t * volatile l, size_t size );
+/*  Free a node no other thread can reach, e.g. one never inserted */
+void lf_dlist_node_free( lf_dlist_t * volatile l, void * node );
+
+/*  Ordered lists. With a key function set, lf_dlist_lower_bound() returns */
+/*  the first live node with a key not below [key] and lf_dlist_find() the */
+/*  one with [key], NULL if there is none. Both walk the list from the head, */
+/*  or from the nearest indexed node in front of [key] once */
+/*  lf_dlist_index_create() has been called: a lock-free skip list */
+/*  (skip_index.h) over a sample of 1 in 2^[sample_shift] nodes, chosen by */
+/*  a hash of their address. The insert_* operations add the sampled nodes */
+/*  to the index, delete/delete_range/pop_* remove them; push_* do not index */
+/*  (a deque is not ordered). Set both before the list is shared, on an */
+/*  empty list. A returned node may be deleted and retired concurrently: */
+/*  call them inside lf_dlist_epoch_enter()/lf_dlist_epoch_exit() to keep */
+/*  reading it. lf_dlist_index_destroy() is for shutdown, after */
+/*  lf_dlist_epoch_barrier(); lf_dlist_finalize() calls it too. */
+void lf_dlist_set_key_fn( lf_dlist_t * volatile l, lf_dlist_key_fn_t key_fn );
+int32_t lf_dlist_index_create( lf_dlist_t * volatile l, uint32_t sample_shift );
+void lf_dlist_index_destroy( lf_dlist_t * volatile l );
+dlist_node_t * lf_dlist_lower_bound( lf_dlist_t * volatile l, int64_t key );
+dlist_node_t * lf_dlist_find( lf_dlist_t * volatile l, int64_t key );
+
+/*  Point lookups: lf_dlist_hash_create() adds a lock-free hash index */
+/*  (hash_index.h) of every node by key, kept up to date by the same */
+/*  operations as the skip list index, and lf_dlist_find() becomes O(1). */
+/*  Keys must be unique; a node is found once the insert_* call linking it */
+/*  has returned. With the hash index lf_dlist_find() does not need the */
+/*  list to be sorted, lf_dlist_lower_bound() still does. Same rules as */
+/*  above for setting it up and for the epoch. */
+int32_t lf_dlist_hash_create( lf_dlist_t * volatile l, uint32_t buckets );
+void lf_dlist_hash_destroy( lf_dlist_t * volatile l );
 
 
 /*  Insert [node] in front of [next] - [node] might end up before another node */
 /*  in case [prev] is being deleted or due to concurrent insertions at the */
-/*  same spot. */
+/*  same spot. If [next] itself gets deleted, [node] goes in front of its live */
+/*  successor. Conflicts are retried internally by repairing the links */
+/*  around [next], so DL_STATUS_OK is returned once [node] is linked. */
 DL_STATUS lf_dlist_insert_before( lf_dlist_t * volatile l,
                                   dlist_node_t * volatile next,
                                   dlist_node_t * volatile node );
 
 /*  Similar to insert_before, but try to insert [node] after [prev]. */
+/*  If [prev] gets deleted, [node] is inserted in front of its successor. */
 DL_STATUS lf_dlist_insert_after( lf_dlist_t * volatile l,
                                  dlist_node_t * volatile prev,
                                  dlist_node_t * volatile node );
 
+/*  Batch inserts: publish the private run [first .. last] with a single CAS */
+/*  on the predecessor's next pointer, then fix the successor's prev pointer. */
+/*  The run must already be linked in both directions, e.g. built with */
+/*  lf_dlist_chain_append(); first == last inserts a single node. The run ends */
+/*  up contiguous, at the position the single-node variants would choose. */
+DL_STATUS lf_dlist_insert_chain_before( lf_dlist_t * volatile l,
+                                        dlist_node_t * volatile next,
+                                        dlist_node_t * volatile first,
+                                        dlist_node_t * volatile last );
+DL_STATUS lf_dlist_insert_chain_after( lf_dlist_t * volatile l,
+                                       dlist_node_t * volatile prev,
+                                       dlist_node_t * volatile first,
+                                       dlist_node_t * volatile last );
+
+/*  Append [node] to the private run [*first .. *last] (both NULL when empty) */
+void lf_dlist_chain_append( dlist_node_t ** first,
+                            dlist_node_t ** last,
+                            dlist_node_t  * node );
+
+/*  Ordered append mode: lf_dlist_seq_take() hands out tickets and */
+/*  lf_dlist_seq_append() publishes the run of a ticket at the tail strictly */
+/*  in ticket order, whatever order the runs arrive in. A run whose */
+/*  predecessors are not all published yet is parked in a ring slot and the */
+/*  call returns at once; whoever publishes the run in front of it goes on */
+/*  with it (the owner, or the thread that was publishing before). Nobody */
+/*  sleeps or retries: the only wait is for a free slot, when a ticket is */
+/*  LF_DLIST_SEQ_RING or more ahead of the oldest unpublished one. */
+/*  A ticket range [ticket, ticket + cnt) comes from lf_dlist_seq_take(); */
+/*  [cnt] may be cut short for the last range of the sequence, and a range */
+/*  that is never appended holds back all later ones: give it up with */
+/*  lf_dlist_seq_cancel(), which publishes an empty run in its place. The */
+/*  run belongs to the list on return even if it is not linked yet. If */
+/*  linking a run fails, the status is returned and the run stays parked */
+/*  in front of the later ones; the next append retries it. Other inserts and */
+/*  pushes at the tail would break the order: in this mode the tail is only */
+/*  appended to through the sequencer. Set up before the list is shared; */
+/*  lf_dlist_finalize() destroys it. */
+#define LF_DLIST_SEQ_RING  256
+
+int32_t lf_dlist_seq_create( lf_dlist_t * volatile l, uint64_t first_ticket );
+void lf_dlist_seq_destroy( lf_dlist_t * volatile l );
+/*  First of [cnt] consecutive tickets */
+uint64_t lf_dlist_seq_take( lf_dlist_t * volatile l, uint32_t cnt );
+/*  The ticket the next lf_dlist_seq_take() starts at */
+uint64_t lf_dlist_seq_next( lf_dlist_t * volatile l );
+/*  Tickets below this one are linked */
+uint64_t lf_dlist_seq_published( lf_dlist_t * volatile l );
+DL_STATUS lf_dlist_seq_append( lf_dlist_t * volatile l,
+                               uint64_t               ticket,
+                               uint32_t               cnt,
+                               dlist_node_t * volatile first,
+                               dlist_node_t * volatile last );
+DL_STATUS lf_dlist_seq_cancel( lf_dlist_t * volatile l,
+                               uint64_t               ticket,
+                               uint32_t               cnt );
+
+/*  Adaptive combining tail: lf_dlist_fc_append() links the run */
+/*  [first .. last] in front of the tail, as insert_chain_before( l, */
+/*  l->tail, ... ) does, and returns once it is linked. It starts in the */
+/*  CAS mode, where each caller links its own run and counts its failed */
+/*  CASes on the tail. Every LF_DLIST_FC_FLUSH appends a thread adds its */
+/*  counts to a window shared by the whole list; when LF_DLIST_FC_WINDOW */
+/*  appends of all threads saw LF_DLIST_FC_HOT_FAILS or more failures, the */
+/*  list switches to flat combining: callers post their run in their slot */
+/*  of a publication array and whoever gets the combiner flag chains every */
+/*  posted run into one and links it with a single insert, while the */
+/*  others wait for their slot to be cleared. When the combiners find fewer */
+/*  than LF_DLIST_FC_COLD_BATCH runs per pass on average over */
+/*  LF_DLIST_FC_WINDOW passes, the list goes back to the CAS mode. */
+/*  Threads past LF_DLIST_FC_SLOTS thread slots always use the CAS mode. */
+/*  The runs of one thread keep their order; runs of different threads are */
+/*  in no particular order, as with concurrent inserts. Set up before the */
+/*  list is shared; lf_dlist_finalize() destroys it. lf_dlist_fc_tune() */
+/*  replaces the three thresholds (the window must not be 0): hot_fails 0 */
+/*  and cold_batch above LF_DLIST_FC_SLOTS switch at the end of every */
+/*  window, both ways. */
+#define LF_DLIST_FC_SLOTS       64
+#define LF_DLIST_FC_WINDOW      64
+#define LF_DLIST_FC_HOT_FAILS   16
+#define LF_DLIST_FC_COLD_BATCH  2
+#define LF_DLIST_FC_FLUSH       8
+
+int32_t lf_dlist_fc_create( lf_dlist_t * volatile l );
+void lf_dlist_fc_destroy( lf_dlist_t * volatile l );
+int32_t lf_dlist_fc_tune( lf_dlist_t * volatile l,
+                          uint32_t               window,
+                          uint32_t               hot_fails,
+                          uint32_t               cold_batch );
+DL_STATUS lf_dlist_fc_append( lf_dlist_t * volatile l,
+                              dlist_node_t * volatile first,
+                              dlist_node_t * volatile last );
+/*  The list is in the combining mode */
+bool lf_dlist_fc_combining( lf_dlist_t * volatile l );
+/*  Mode switches so far, both ways */
+uint64_t lf_dlist_fc_switches( lf_dlist_t * volatile l );
+
+/*  Deque operations on the two ends of the list. They need no cursor and */
+/*  fix only the one link next to the end, not a generic correct_prev walk. */
+/*  pop_* return DL_STATUS_NOT_FOUND (and NULL in [*node]) on an empty list. */
+/*  A popped node may still be read by concurrent operations: free it with */
+/*  lf_dlist_retire(). On a list with moves (lf_dlist_move_create()) they */
+/*  pop the node a proxy stands for, and may return DL_STATUS_OUT_OF_MEMORY */
+/*  (see lf_dlist_delete()). */
+DL_STATUS lf_dlist_push_front( lf_dlist_t * volatile l, dlist_node_t * volatile node );
+DL_STATUS lf_dlist_push_back( lf_dlist_t * volatile l, dlist_node_t * volatile node );
+DL_STATUS lf_dlist_pop_front( lf_dlist_t * volatile l, dlist_node_t ** node );
+DL_STATUS lf_dlist_pop_back( lf_dlist_t * volatile l, dlist_node_t ** node );
+
+/*  Delete [node]. Both directions are repaired locally before returning: */
+/*  the prev pointer of [node] is marked, the predecessor's next pointer is */
+/*  swung past it and the successor's prev pointer is CAS-ed back to the */
+/*  predecessor, stepping over neighbours deleted meanwhile. Callers need */
+/*  no repair walk (get_prev/correct_next up to the head) afterwards. */
+/*  DL_STATUS_OK if this call deleted [node]: it is the caller's to retire. */
+/*  DL_STATUS_NOT_FOUND if someone else deleted it first. On a list with */
+/*  moves [node] is deleted wherever it was moved to, and a move in flight */
+/*  gives way; the proxy standing for it is retired by the call, so */
+/*  DL_STATUS_OUT_OF_MEMORY (with [node] untouched) if there is no room to */
+/*  retire it, see epoch_retire_reserve(). */
 DL_STATUS lf_dlist_delete( lf_dlist_t * volatile l, dlist_node_t * volatile node );
+
+/*  Delete the contiguous run [first .. last] ([last] must follow [first]). */
+/*  Every node of the run is logically deleted in order, then the run is */
+/*  unlinked with a single CAS on the surviving predecessor's next pointer. */
+/*  Nodes inserted inside the run before it is marked are deleted with it. */
+/*  If [last] is deleted concurrently, the run ends where the walk noticed */
+/*  it and DL_STATUS_INCOMPLETE is returned. The links around the run are */
+/*  repaired as lf_dlist_delete() does. DL_STATUS_NOT_SUPPORTED on a list */
+/*  with moves, as take_* and transfer: a run may hold proxies. */
+DL_STATUS lf_dlist_delete_range( lf_dlist_t * volatile l,
+                                 dlist_node_t * volatile first,
+                                 dlist_node_t * volatile last );
+
+/*  Bulk detach: unlink the first [n] live nodes (take_prefix) or every */
+/*  node (take_all) from the front of the list and return them as a chain */
+/*  [*first .. *last]. Nodes inserted inside the run while it is being */
+/*  marked are taken with it; nodes appended behind it are not. Each node */
+/*  is marked as lf_dlist_delete() marks it, one CAS on its next pointer */
+/*  and one on its prev pointer, but the run is unlinked with a single CAS */
+/*  on head->next and only the prev pointer of the node behind the run is */
+/*  repaired: there is no per-node unlink. If another thread deletes the */
+/*  last node meanwhile, the run ends before it: [*last] is set to the */
+/*  node it really ended at (both NULL if none was taken) and */
+/*  DL_STATUS_INCOMPLETE is returned. The chain keeps the frozen next */
+/*  pointers of the nodes: walk it with */
+/*  lf_dlist_dereference_node_pointer_mem_only( node->next ) up to */
+/*  [*last], reading a node's next before freeing it. Concurrent */
+/*  readers may still hold the nodes, free them with lf_dlist_retire_node() */
+/*  unless there are none. */
+/*  The caller must be the only one deleting or moving nodes of the list: */
+/*  a node someone else deleted inside the run would still be on the */
+/*  chain. Inserts and pushes may go on. DL_STATUS_NOT_FOUND (and NULL) */
+/*  on an empty list. */
+DL_STATUS lf_dlist_take_prefix( lf_dlist_t    * volatile l,
+                                int64_t                  n,
+                                dlist_node_t          ** first,
+                                dlist_node_t          ** last );
+DL_STATUS lf_dlist_take_all( lf_dlist_t    * volatile l,
+                             dlist_node_t          ** first,
+                             dlist_node_t          ** last );
+
+/*  Cross-list transfer of intrusive nodes with a hook per list: delete the */
+/*  live [node] from [src] and append it to [dst] on its other hook, found */
+/*  [dst_hook_offset] bytes from its [src] hook (e.g. the offset of ag_prev */
+/*  in a node whose prev/next link it into src). The dst hook is chained as */
+/*  soon as the node is marked in src and published before dst's tail with */
+/*  a single CAS: bounded work, no waiting on readers. In between the node */
+/*  is on neither list, so a reader of both may miss it. */
+/*  DL_STATUS_NOT_FOUND if someone else deleted [node] first (it is left */
+/*  to them). The range variant transfers [first .. last] as */
+/*  lf_dlist_delete_range() deletes it, keeping the order; only the nodes */
+/*  this call deleted are transferred, and DL_STATUS_INCOMPLETE if */
+/*  [last] got deleted meanwhile. */
+DL_STATUS lf_dlist_transfer( lf_dlist_t   * volatile src,
+                             lf_dlist_t   * volatile dst,
+                             dlist_node_t * volatile node,
+                             ptrdiff_t               dst_hook_offset );
+DL_STATUS lf_dlist_transfer_range( lf_dlist_t   * volatile src,
+                                   lf_dlist_t   * volatile dst,
+                                   dlist_node_t * volatile first,
+                                   dlist_node_t * volatile last,
+                                   ptrdiff_t               dst_hook_offset );
+
+/*  LRU promotion. lf_dlist_move_create() enables the moves of a list: its */
+/*  nodes embed an lf_dlist_move_ref_t [ref_offset] bytes from their link, */
+/*  not overlapping it, which the insert_* and push_* calls clear. A node */
+/*  deleted from such a list is inserted again only after it went through */
+/*  lf_dlist_retire() or a barrier, as with any list. lf_dlist_move_to_tail() */
+/*  (move_to_head()) relocates the live [node] right in front of the tail */
+/*  (behind the head) without it ever leaving the list: a proxy from a node */
+/*  pool of the list is linked at that end first and stands for the node */
+/*  from then on, and only then is the old position unlinked. The node's */
+/*  own link is not linked again until the node is deleted and inserted */
+/*  anew, so no move waits for a grace period or leaves work behind. */
+/*  get_next/get_prev, cursors and lower_bound return the node in place of */
+/*  its proxy. Like an iterator across std::list::splice(), a traversal */
+/*  standing on the node goes on from its new place, so what was between */
+/*  is skipped; otherwise a traversal running while it moves meets it once */
+/*  or twice, unless it is moved behind the traversal. pop_* and */
+/*  lf_dlist_delete() take it wherever it is, and a delete or pop racing */
+/*  with the move wins without waiting. Its size count and its hash index */
+/*  entry are left as they are. A node already within */
+/*  DL_MOVE_HOT_DISTANCE links of that end, or moved by another thread */
+/*  meanwhile, stays where it is: promotions of a hot node coalesce into */
+/*  DL_STATUS_OK without any write. [node] must stay readable until the */
+/*  call is made, e.g. with a hazard pointer published where it was found. */
+/*  DL_STATUS_NOT_FOUND if [node] is deleted, DL_STATUS_OUT_OF_MEMORY (with */
+/*  [node] untouched) if no proxy or no room to retire one is left, */
+/*  DL_STATUS_NOT_SUPPORTED on a list without moves. The skip list index */
+/*  does not go with moves: lf_dlist_move_create() fails on an indexed list */
+/*  and lf_dlist_index_create() on a list with moves. Set it up before the */
+/*  list is shared, on an empty list; lf_dlist_move_destroy() is for */
+/*  shutdown, after lf_dlist_epoch_barrier(), and lf_dlist_finalize() */
+/*  calls it too. */
+#define DL_MOVE_HOT_DISTANCE  8
+
+typedef struct _lf_dlist_move_ref lf_dlist_move_ref_t;
+struct _lf_dlist_move_ref
+{
+  /*  the proxy standing for the node, NULL while it is on its own link; */
+  /*  DL_NODE_DELETED once the node is deleted. In a proxy: the node it */
+  /*  stands for, with DL_NODE_DIRTY. */
+  dlist_link_t holder;
+};
+
+int32_t lf_dlist_move_create( lf_dlist_t * volatile l, ptrdiff_t ref_offset );
+void lf_dlist_move_destroy( lf_dlist_t * volatile l );
+DL_STATUS lf_dlist_move_to_tail( lf_dlist_t * volatile l, dlist_node_t * volatile node );
+DL_STATUS lf_dlist_move_to_head( lf_dlist_t * volatile l, dlist_node_t * volatile node );
+
 dlist_node_t * lf_dlist_get_next( lf_dlist_t * volatile l, dlist_node_t * volatile node );
 dlist_node_t * lf_dlist_get_prev( lf_dlist_t * volatile l, dlist_node_t * volatile node );
 
 dlist_node_t * lf_dlist_correct_next( lf_dlist_t * volatile l, dlist_node_t * volatile node );
 
 /*  Set the deleted bit on the given node */
-void lf_dlist_mark_node_pointer( lf_dlist_t * volatile l, dlist_node_t ** volatile node );
+void lf_dlist_mark_node_pointer( lf_dlist_t * volatile l, dlist_link_t * node );
 
 /*  Extract the real underlying node (masking out the MSB and flush if needed) */
 /* Do NOT use this macro function, if PMEM mode. */
@@ -99,12 +467,39 @@ void lf_dlist_mark_node_pointer( lf_dlist_t * volatile l, dlist_node_t ** volati
   (dlist_node_t * volatile)((uint64_t)(_node) & DL_NODE_DELETED_MASK)
 
 dlist_node_t * lf_dlist_dereference_node_pointer( lf_dlist_t    * volatile l,
-                                                  dlist_node_t ** volatile node );
+                                                  dlist_link_t  * node );
 bool lf_dlist_marked_next( dlist_node_t * volatile node );
 bool lf_dlist_marked_prev( dlist_node_t * volatile node );
+/*  [node] is in the list: not deleted, wherever a move put it. Without */
+/*  moves, the same as lf_dlist_marked_next() == false */
+bool lf_dlist_linked( lf_dlist_t * volatile l, dlist_node_t * volatile node );
+
+/*  Safe memory reclamation (epoch based, see epoch.h). */
+/*  Nodes are only read inside an epoch critical section: the insert, */
+/*  delete and push/pop operations enter one by themselves, and so does a */
+/*  cursor for each move (see below). get_next/get_prev/correct_next */
+/*  expect the caller to be inside one already. A deleted node that other threads may still */
+/*  read is handed to lf_dlist_retire() instead of being freed; [free_fn] */
+/*  gets [node] back after a grace period. */
+void lf_dlist_epoch_enter( void );
+void lf_dlist_epoch_exit( void );
+/*  Wait for a grace period and free the retired nodes; see epoch_barrier() */
+void lf_dlist_epoch_barrier( void );
+int32_t lf_dlist_retire( dlist_node_t * volatile node, lf_dlist_free_fn_t free_fn );
+/*  lf_dlist_retire() with the free function of the allocator of [l] */
+int32_t lf_dlist_retire_node( lf_dlist_t * volatile l, void * node );
 
 /******************************************************************************
  * dlist_cursor_t */
+
+/*  A cursor publishes two hazard pointers (see epoch.h): the node it is on */
+/*  and the node its last move started from, so both can be read */
+/*  between two moves while the thread stays outside of the epoch; a long */
+/*  scan does not hold back reclamation. If the current node is deleted */
+/*  meanwhile, the next move resumes from the other node if that one is */
+/*  still linked, from the head (tail) of the list otherwise. */
+/*  If the thread is out of hazard slots, the cursor holds the epoch from */
+/*  open to close instead. */
 typedef enum _dlist_cursor_move_direction dlist_cursor_dir_t;
 enum _dlist_cursor_move_direction
 {
@@ -113,15 +508,18 @@ enum _dlist_cursor_move_direction
   DL_CURSOR_DIR_BACKWARD = 2   // tail -> head
 };
 
-typedef volatile struct _dlist_cursor _dlist_cursor_t;
-#define dlist_cursor_t volatile _dlist_cursor_t
+typedef ATOMIC_VOLATILE struct _dlist_cursor _dlist_cursor_t;
+#define dlist_cursor_t ATOMIC_VOLATILE _dlist_cursor_t
 struct _dlist_cursor
 {
-  lf_dlist_t   * volatile l;
-  dlist_node_t * volatile cur_node;
-  dlist_node_t * volatile head;
-  dlist_node_t * volatile tail;
+  lf_dlist_t   * ATOMIC_VOLATILE l;
+  dlist_node_t * ATOMIC_VOLATILE cur_node;
+  dlist_node_t * ATOMIC_VOLATILE head;
+  dlist_node_t * ATOMIC_VOLATILE tail;
+  /*  the node the last move started from, behind cur_node in [dir] */
+  dlist_node_t * ATOMIC_VOLATILE last_node;
   dlist_cursor_dir_t dir;
+  int32_t        hazard[2];  /*  slots of cur_node and last_node, or -1 */
 };
 
 int32_t dlist_cursor_open( dlist_cursor_t    * volatile c,
@@ -131,8 +529,31 @@ void dlist_cursor_close( dlist_cursor_t * volatile c );
 bool dlist_cursor_is_eol( dlist_cursor_t * volatile c );
 
 void dlist_cursor_reset( dlist_cursor_t * volatile c );
+/*  Put the cursor on [node] as if its last move had ended there: the next */
+/*  move goes on from [node], or from the head (tail) if it is deleted by */
+/*  then. The caller keeps [node] readable until the call returns (epoch */
+/*  or a hazard slot of its own); the cursor holds it from then on. */
+void dlist_cursor_seek( dlist_cursor_t * volatile c, dlist_node_t * node );
 dlist_node_t * dlist_cursor_next( dlist_cursor_t * volatile c );
 dlist_node_t * dlist_cursor_prev( dlist_cursor_t * volatile c );
+
+/*  Delete the node the cursor is on and leave the cursor on its live */
+/*  successor in the direction of the last move (the tail or head at the */
+/*  end): a sweep goes on from there instead of restarting at the head. */
+/*  The status of lf_dlist_delete(); the cursor moves on whatever it is. */
+DL_STATUS dlist_cursor_remove( dlist_cursor_t * volatile c );
+
+/*  One pass from the cursor position to the end of the list, in the */
+/*  direction of the last move: delete every node [pred] returns true for. */
+/*  [erased] (may be NULL) gets each node this pass deleted, unlinked and */
+/*  no longer held by the cursor, e.g. to retire it. Returns their number; */
+/*  the cursor is left at the end of the list. */
+typedef bool (*dlist_pred_fn_t)( dlist_node_t * node, void * ctx );
+typedef void (*dlist_erase_fn_t)( dlist_node_t * node, void * ctx );
+int64_t dlist_cursor_erase_if( dlist_cursor_t * volatile c,
+                               dlist_pred_fn_t           pred,
+                               dlist_erase_fn_t          erased,
+                               void                    * ctx );
 #else // IMPRV_PERF
 
 #endif /* _DOUBLEY_LINKED_LIST_H_ */
@@ -0,0 +1,396 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include "atomic.h"
+#include "node_pool.h"
+#include "util.h"
+
+#define NODE_POOL_CACHE_LINE  64
+
+/* The global stack of batches is a tagged pointer: user space addresses fit
+ * in the lower 48 bits, the upper 16 bits count the updates of the top so
+ * that a batch popped and pushed back meanwhile (ABA) fails the CAS. */
+#define NODE_POOL_TAG_SHIFT   48
+#define NODE_POOL_PTR_MASK    (((uint64_t)1 << NODE_POOL_TAG_SHIFT) - 1)
+
+#define node_pool_top_ptr( _top ) \
+  ((node_pool_obj_t *)((_top) & NODE_POOL_PTR_MASK))
+#define node_pool_top_make( _old, _ptr ) \
+  (((((_old) >> NODE_POOL_TAG_SHIFT) + 1) << NODE_POOL_TAG_SHIFT) | (uint64_t)(_ptr))
+
+/* A free object; the batch fields are valid in the first object only */
+typedef struct _node_pool_obj node_pool_obj_t;
+struct _node_pool_obj
+{
+  node_pool_obj_t * next;        /* next object of the batch */
+  node_pool_obj_t * batch_next;  /* next batch of the global stack */
+  uint32_t          batch_cnt;
+};
+
+/* Header in the first cache line of a slab */
+typedef struct _node_pool_slab node_pool_slab_t;
+struct _node_pool_slab
+{
+  node_pool_t       * pool;
+  node_pool_slab_t  * next;
+};
+
+/* Cache of a thread slot, only touched by the thread owning the slot */
+typedef struct _node_pool_cache node_pool_cache_t;
+struct _node_pool_cache
+{
+  node_pool_obj_t * cur;      /* objects to hand out / to free into */
+  uint32_t          cur_cnt;
+  node_pool_obj_t * full;     /* a full batch kept back, or NULL */
+} __attribute__((aligned(64)));
+
+struct _node_pool
+{
+  uint64_t ATOMIC_VAR  batches;  /* tagged top of the global batch stack */
+  char                 pad[NODE_POOL_CACHE_LINE - sizeof(uint64_t)];
+
+  uint32_t             obj_size;
+  uint32_t             flags;
+
+  /* slab growth is rare: a mutex is enough */
+  pthread_mutex_t      slab_mtx;
+  node_pool_slab_t   * slabs;
+  uint32_t             slab_cnt;
+  char               * carve_pos;
+  char               * carve_end;
+
+  node_pool_cache_t    caches[THREAD_SLOT_MAX];
+} __attribute__((aligned(64)));
+
+static void node_pool_push_batch( node_pool_t * pool, node_pool_obj_t * first )
+{
+  uint64_t top = 0;
+
+  while( true )
+    {
+      top = atomic_load_acq( &(pool->batches) );
+      first->batch_next = node_pool_top_ptr( top );
+      if( atomic_cas_ptr( &(pool->batches), top, node_pool_top_make( top, first ) ) )
+        {
+          break;
+        }
+      cpu_relax();
+    }
+}
+
+static node_pool_obj_t * node_pool_pop_batch( node_pool_t * pool )
+{
+  node_pool_obj_t * first = NULL;
+  uint64_t          top = 0;
+
+  while( true )
+    {
+      top   = atomic_load_acq( &(pool->batches) );
+      first = node_pool_top_ptr( top );
+      if( first == NULL )
+        {
+          return NULL;
+        }
+
+      /* [first] may be popped and reused meanwhile: its memory stays */
+      /* mapped and the tag makes the CAS fail */
+      if( atomic_cas_ptr( &(pool->batches),
+                          top,
+                          node_pool_top_make( top, first->batch_next ) ) )
+        {
+          return first;
+        }
+      cpu_relax();
+    }
+}
+
+/* Pre-fault [len] bytes at [addr] */
+static void node_pool_prefault( char * addr, uint64_t len )
+{
+  uint64_t off = 0;
+
+#ifdef MADV_POPULATE_WRITE
+  if( madvise( addr, len, MADV_POPULATE_WRITE ) == 0 )
+    {
+      return;
+    }
+#endif
+
+  for( off = 0 ; off < len ; off += 4096 )
+    {
+      addr[off] = 0;
+    }
+}
+
+/* Map a slab aligned to NODE_POOL_SLAB_SIZE */
+static node_pool_slab_t * node_pool_map_slab( node_pool_t * pool )
+{
+  int32_t  prot  = PROT_READ | PROT_WRITE;
+  int32_t  flags = MAP_PRIVATE | MAP_ANONYMOUS;
+  char   * raw   = MAP_FAILED;
+  char   * slab  = NULL;
+  uint64_t head  = 0;
+
+#ifdef MAP_HUGETLB
+  if( pool->flags & NODE_POOL_HUGE_PAGE )
+    {
+      /* hugetlb mappings are aligned to the huge page size already */
+      raw = (char *)mmap( NULL, NODE_POOL_SLAB_SIZE, prot,
+                          flags | MAP_HUGETLB |
+                          ((pool->flags & NODE_POOL_POPULATE) ? MAP_POPULATE : 0),
+                          -1, 0 );
+      if( raw != MAP_FAILED )
+        {
+          return (node_pool_slab_t *)raw;
+        }
+    }
+#endif
+
+  /* no huge pages reserved: map twice the size and trim it to alignment */
+  raw = (char *)mmap( NULL, NODE_POOL_SLAB_SIZE * 2, prot, flags | MAP_NORESERVE, -1, 0 );
+  TRY( raw == MAP_FAILED );
+
+  slab = (char *)(((uint64_t)raw + NODE_POOL_SLAB_SIZE - 1) & ~(NODE_POOL_SLAB_SIZE - 1));
+  head = (uint64_t)(slab - raw);
+  if( head > 0 )
+    {
+      (void)munmap( raw, head );
+    }
+  (void)munmap( slab + NODE_POOL_SLAB_SIZE, NODE_POOL_SLAB_SIZE - head );
+
+#ifdef MADV_HUGEPAGE
+  if( pool->flags & NODE_POOL_HUGE_PAGE )
+    {
+      /* fall back to transparent huge pages */
+      (void)madvise( slab, NODE_POOL_SLAB_SIZE, MADV_HUGEPAGE );
+    }
+#endif
+
+  if( pool->flags & NODE_POOL_POPULATE )
+    {
+      node_pool_prefault( slab, NODE_POOL_SLAB_SIZE );
+    }
+
+  return (node_pool_slab_t *)slab;
+
+  CATCH_END;
+
+  return NULL;
+}
+
+/* Cut a batch of fresh objects out of the slabs */
+static node_pool_obj_t * node_pool_carve_batch( node_pool_t * pool )
+{
+  node_pool_slab_t * slab  = NULL;
+  node_pool_obj_t  * first = NULL;
+  node_pool_obj_t  * obj   = NULL;
+  uint32_t           cnt   = 0;
+
+  pthread_mutex_lock( &(pool->slab_mtx) );
+
+  while( cnt < NODE_POOL_BATCH )
+    {
+      if( pool->carve_pos + pool->obj_size > pool->carve_end )
+        {
+          slab = node_pool_map_slab( pool );
+          if( slab == NULL )
+            {
+              break;
+            }
+
+          slab->pool = pool;
+          slab->next = pool->slabs;
+          pool->slabs = slab;
+          pool->slab_cnt++;
+
+          pool->carve_pos = (char *)slab + NODE_POOL_CACHE_LINE;
+          pool->carve_end = (char *)slab + NODE_POOL_SLAB_SIZE;
+        }
+
+      obj = (node_pool_obj_t *)pool->carve_pos;
+      pool->carve_pos += pool->obj_size;
+
+      obj->next = first;
+      first = obj;
+      cnt++;
+    }
+
+  pthread_mutex_unlock( &(pool->slab_mtx) );
+
+  if( first != NULL )
+    {
+      first->batch_cnt = cnt;
+    }
+
+  return first;
+}
+
+int32_t node_pool_create( node_pool_t ** _pool, uint32_t obj_size, uint32_t flags )
+{
+  node_pool_t * pool = NULL;
+
+  TRY( _pool == NULL || obj_size == 0 );
+
+  /* a free object must hold node_pool_obj_t, and objects never share */
+  /* a cache line */
+  if( obj_size < sizeof(node_pool_obj_t) )
+    {
+      obj_size = sizeof(node_pool_obj_t);
+    }
+  obj_size = (obj_size + NODE_POOL_CACHE_LINE - 1) & ~(NODE_POOL_CACHE_LINE - 1);
+  TRY( obj_size > NODE_POOL_SLAB_SIZE - NODE_POOL_CACHE_LINE );
+
+  TRY( posix_memalign( (void **)&pool, NODE_POOL_CACHE_LINE, sizeof(node_pool_t) ) != 0 );
+  memset( (void *)pool, 0x00, sizeof(node_pool_t) );
+
+  pool->obj_size = obj_size;
+  pool->flags    = flags;
+  pthread_mutex_init( &(pool->slab_mtx), NULL );
+
+  *_pool = pool;
+
+  return RC_SUCCESS;
+
+  CATCH_END;
+
+  return RC_FAIL;
+}
+
+void node_pool_destroy( node_pool_t * pool )
+{
+  node_pool_slab_t * slab = NULL;
+  node_pool_slab_t * next = NULL;
+
+  if( pool == NULL )
+    {
+      return;
+    }
+
+  for( slab = pool->slabs ; slab != NULL ; slab = next )
+    {
+      next = slab->next;
+      (void)munmap( (void *)slab, NODE_POOL_SLAB_SIZE );
+    }
+
+  pthread_mutex_destroy( &(pool->slab_mtx) );
+  free( pool );
+}
+
+void * node_pool_alloc( node_pool_t * pool )
+{
+  node_pool_cache_t * cache = NULL;
+  node_pool_obj_t   * obj   = NULL;
+  node_pool_obj_t   * rest  = NULL;
+  int32_t             slot  = thread_slot_id();
+
+  if( slot < 0 )
+    {
+      /* no cache: take one object of a batch and put the rest back */
+      obj = node_pool_pop_batch( pool );
+      if( obj == NULL )
+        {
+          obj = node_pool_carve_batch( pool );
+          TRY( obj == NULL );
+        }
+
+      rest = obj->next;
+      if( rest != NULL )
+        {
+          rest->batch_cnt = obj->batch_cnt - 1;
+          node_pool_push_batch( pool, rest );
+        }
+    }
+  else
+    {
+      cache = &(pool->caches[slot]);
+
+      if( cache->cur == NULL )
+        {
+          if( cache->full != NULL )
+            {
+              cache->cur  = cache->full;
+              cache->full = NULL;
+            }
+          else
+            {
+              cache->cur = node_pool_pop_batch( pool );
+              if( cache->cur == NULL )
+                {
+                  cache->cur = node_pool_carve_batch( pool );
+                  TRY( cache->cur == NULL );
+                }
+            }
+          cache->cur_cnt = cache->cur->batch_cnt;
+        }
+
+      obj = cache->cur;
+      cache->cur = obj->next;
+      cache->cur_cnt--;
+    }
+
+  memset( (void *)obj, 0x00, pool->obj_size );
+
+  return (void *)obj;
+
+  CATCH_END;
+
+  return NULL;
+}
+
+void node_pool_free( void * _obj )
+{
+  node_pool_obj_t   * obj   = (node_pool_obj_t *)_obj;
+  node_pool_t       * pool  = NULL;
+  node_pool_cache_t * cache = NULL;
+  int32_t             slot  = 0;
+
+  if( obj == NULL )
+    {
+      return;
+    }
+
+  pool = ((node_pool_slab_t *)((uint64_t)obj & ~(NODE_POOL_SLAB_SIZE - 1)))->pool;
+  slot = thread_slot_id();
+
+  if( slot < 0 )
+    {
+      obj->next = NULL;
+      obj->batch_cnt = 1;
+      node_pool_push_batch( pool, obj );
+      return;
+    }
+
+  cache = &(pool->caches[slot]);
+
+  obj->next = cache->cur;
+  cache->cur = obj;
+  cache->cur_cnt++;
+
+  if( cache->cur_cnt == NODE_POOL_BATCH )
+    {
+      /* keep one full batch for the next allocations, publish the other */
+      if( cache->full != NULL )
+        {
+          node_pool_push_batch( pool, cache->full );
+        }
+
+      cache->cur->batch_cnt = NODE_POOL_BATCH;
+      cache->full    = cache->cur;
+      cache->cur     = NULL;
+      cache->cur_cnt = 0;
+    }
+}
+
+uint32_t node_pool_obj_size( node_pool_t * pool )
+{
+  return pool->obj_size;
+}
+
+uint32_t node_pool_slab_count( node_pool_t * pool )
+{
+  return pool->slab_cnt;
+}
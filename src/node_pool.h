@@ -0,0 +1,41 @@
+#ifndef _NODE_POOL_H_
+#define _NODE_POOL_H_ 1
+
+#include <stdint.h>
+#include "util.h"
+
+/* ****************************************************************************
+ * Fixed-size node pool.
+ *
+ * Objects are carved out of slabs of NODE_POOL_SLAB_SIZE bytes, aligned to
+ * their size, so the owning pool of an object is found from its address and
+ * node_pool_free() fits where a free() function is expected (e.g.
+ * lf_dlist_retire()). Objects are cache line aligned and padded.
+ *
+ * Every thread slot (util.h) has a cache of up to two batches of
+ * NODE_POOL_BATCH objects; full batches are exchanged with a lock-free
+ * global stack of batches with a single CAS, so objects freed by one thread
+ * (e.g. an ager) are handed out to the allocating threads as they are.
+ * Slabs are only returned to the system by node_pool_destroy(). */
+
+#define NODE_POOL_SLAB_SIZE  ((uint64_t)2 << 20)  /* one huge page */
+#define NODE_POOL_BATCH      64
+
+/* node_pool_create() flags */
+#define NODE_POOL_HUGE_PAGE  0x1  /* back slabs with huge pages if possible */
+#define NODE_POOL_POPULATE   0x2  /* pre-fault slabs (MAP_POPULATE) */
+
+typedef struct _node_pool node_pool_t;
+
+int32_t node_pool_create( node_pool_t ** pool, uint32_t obj_size, uint32_t flags );
+/* Unmaps every slab: all objects must be freed (or never be used again) */
+void node_pool_destroy( node_pool_t * pool );
+
+/* Returns a zero-filled object, NULL if out of memory */
+void * node_pool_alloc( node_pool_t * pool );
+void node_pool_free( void * obj );
+
+uint32_t node_pool_obj_size( node_pool_t * pool );
+uint32_t node_pool_slab_count( node_pool_t * pool );
+
+#endif /* _NODE_POOL_H_ */
@@ -0,0 +1,247 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "atomic.h"
+#include "parallel_dlist.h"
+#include "util.h"
+
+typedef struct _lf_dlist_par lf_dlist_par_t;
+
+/* [span] holds the ranges a thread has left, [lo, hi) with lo in the upper
+ * half: the owner takes lo, thieves take hi - 1, each with a CAS on the
+ * pair, so a range is taken once */
+typedef struct _lf_dlist_par_worker lf_dlist_par_worker_t;
+struct _lf_dlist_par_worker
+{
+  uint64_t ATOMIC_VAR  span;
+  int64_t              visited;
+  lf_dlist_par_t     * par;
+  int32_t              id;
+  pthread_t            thr;
+} __attribute__((aligned(64)));
+
+struct _lf_dlist_par
+{
+  lf_dlist_t            * l;
+  lf_dlist_visit_fn_t     fn;
+  void                  * ctx;
+  /* range r is [split[r], split[r + 1]); split[range_cnt] is NULL, the tail */
+  dlist_node_t         ** split;
+  uint32_t                range_cnt;
+  uint32_t                worker_cnt;
+  lf_dlist_par_worker_t * workers;
+};
+
+#define lf_dlist_par_span( _lo, _hi ) \
+  (((uint64_t)(_lo) << 32) | (uint64_t)(_hi))
+#define lf_dlist_par_lo( _span )  ((uint32_t)((_span) >> 32))
+#define lf_dlist_par_hi( _span )  ((uint32_t)(_span))
+
+/* Next range of [w] (its first left, or its last one for a thief), -1 if
+ * it has none left */
+static int64_t lf_dlist_par_take( lf_dlist_par_worker_t * w, bool steal )
+{
+  uint64_t span = 0;
+  uint32_t lo   = 0;
+  uint32_t hi   = 0;
+
+  while( true )
+    {
+      span = atomic_load_acq( &(w->span) );
+      lo   = lf_dlist_par_lo( span );
+      hi   = lf_dlist_par_hi( span );
+      if( lo >= hi )
+        {
+          return -1;
+        }
+
+      if( steal == true )
+        {
+          if( atomic_cas_ptr( &(w->span), span, lf_dlist_par_span( lo, hi - 1 ) ) )
+            {
+              return (int64_t)(hi - 1);
+            }
+        }
+      else
+        {
+          if( atomic_cas_ptr( &(w->span), span, lf_dlist_par_span( lo + 1, hi ) ) )
+            {
+              return (int64_t)lo;
+            }
+        }
+    }
+}
+
+/* Call fn on the nodes of range [r]; returns their number */
+static int64_t lf_dlist_par_walk( lf_dlist_par_t * par, uint32_t r )
+{
+  lf_dlist_t   * l    = par->l;
+  dlist_node_t * node = par->split[r];
+  dlist_node_t * end  = par->split[r + 1];
+  uint32_t       next = r + 1;
+  int64_t        cnt  = 0;
+
+  lf_dlist_epoch_enter();
+
+  if( node == l->head || lf_dlist_marked_next( node ) == true )
+    {
+      node = lf_dlist_get_next( l, node );
+    }
+
+  while( node != NULL && node != l->tail )
+    {
+      /* the split point itself, deleted or not, belongs to the next range */
+      if( node == end )
+        {
+          break;
+        }
+
+      /* a deleted split point may never be met: end at the next one */
+      while( end != NULL && lf_dlist_marked_next( end ) == true )
+        {
+          end = par->split[++next];
+        }
+
+      if( node == end )
+        {
+          break;
+        }
+
+      /* deleted since get_next() returned it: step over it, as the */
+      /* cursor does */
+      if( lf_dlist_marked_next( node ) == false )
+        {
+          par->fn( node, par->ctx );
+          cnt++;
+        }
+
+      node = lf_dlist_get_next( l, node );
+    }
+
+  lf_dlist_epoch_exit();
+
+  return cnt;
+}
+
+static void lf_dlist_par_run( lf_dlist_par_worker_t * w )
+{
+  lf_dlist_par_t        * par    = w->par;
+  lf_dlist_par_worker_t * victim = NULL;
+  int64_t                 r = 0;
+  uint32_t                i = 0;
+
+  while( (r = lf_dlist_par_take( w, false )) >= 0 )
+    {
+      w->visited += lf_dlist_par_walk( par, (uint32_t)r );
+    }
+
+  /* no range is ever added: one round over the others is enough */
+  for( i = 1 ; i < par->worker_cnt ; i++ )
+    {
+      victim = &(par->workers[(w->id + i) % par->worker_cnt]);
+      while( (r = lf_dlist_par_take( victim, true )) >= 0 )
+        {
+          w->visited += lf_dlist_par_walk( par, (uint32_t)r );
+        }
+    }
+}
+
+static void * lf_dlist_par_main( void * arg )
+{
+  lf_dlist_par_run( (lf_dlist_par_worker_t *)arg );
+
+  return NULL;
+}
+
+int64_t lf_dlist_parallel_for( lf_dlist_t        * volatile l,
+                               uint32_t                     nthreads,
+                               lf_dlist_visit_fn_t          fn,
+                               void                       * ctx )
+{
+  lf_dlist_par_t   par;
+  int64_t          visited  = 0;
+  uint32_t         range_max = 0;
+  uint32_t         started  = 1;
+  uint32_t         i        = 0;
+
+  TRY( l == NULL || fn == NULL );
+  /* the split points are sampled from the index, never walked */
+  TRY( l->index == NULL );
+  TRY( nthreads == 0 || nthreads > LF_DLIST_PAR_THREAD_MAX );
+
+  memset( (void *)&par, 0x00, sizeof(lf_dlist_par_t) );
+  par.l          = l;
+  par.fn         = fn;
+  par.ctx        = ctx;
+  par.worker_cnt = nthreads;
+
+  range_max = nthreads * LF_DLIST_PAR_GRAIN;
+  par.split = (dlist_node_t **)malloc( (range_max + 1) * sizeof(dlist_node_t *) );
+  TRY( par.split == NULL );
+
+  TRY_GOTO( posix_memalign( (void **)&(par.workers),
+                            64,
+                            nthreads * sizeof(lf_dlist_par_worker_t) ) != 0,
+            err_alloc_workers );
+  memset( (void *)par.workers, 0x00, nthreads * sizeof(lf_dlist_par_worker_t) );
+
+  /* held until the workers are done: the split points stay readable */
+  lf_dlist_epoch_enter();
+
+  /* split points: a sample of the skip list index, in list order */
+  par.split[0]  = l->head;
+  par.range_cnt = 1 + (uint32_t)skip_index_sample( l->index,
+                                                   (void **)&(par.split[1]),
+                                                   (int32_t)range_max - 1 );
+  par.split[par.range_cnt] = NULL;
+
+  /* a block of consecutive ranges per thread */
+  for( i = 0 ; i < nthreads ; i++ )
+    {
+      par.workers[i].par  = &par;
+      par.workers[i].id   = (int32_t)i;
+      par.workers[i].span = lf_dlist_par_span( (uint64_t)par.range_cnt * i / nthreads,
+                                               (uint64_t)par.range_cnt * (i + 1) / nthreads );
+    }
+
+  /* the ranges of a thread that could not be started are stolen */
+  for( started = 1 ; started < nthreads ; started++ )
+    {
+      if( pthread_create( &(par.workers[started].thr),
+                          NULL,
+                          lf_dlist_par_main,
+                          &(par.workers[started]) ) != 0 )
+        {
+          break;
+        }
+    }
+
+  lf_dlist_par_run( &(par.workers[0]) );
+
+  for( i = 1 ; i < started ; i++ )
+    {
+      (void)pthread_join( par.workers[i].thr, NULL );
+    }
+
+  lf_dlist_epoch_exit();
+
+  for( i = 0 ; i < nthreads ; i++ )
+    {
+      visited += par.workers[i].visited;
+    }
+
+  free( par.workers );
+  free( par.split );
+
+  return visited;
+
+  CATCH( err_alloc_workers )
+    {
+      free( par.split );
+    }
+  CATCH_END;
+
+  return -1;
+}
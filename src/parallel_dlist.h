@@ -0,0 +1,52 @@
+#ifndef _PARALLEL_DLIST_H_
+#define _PARALLEL_DLIST_H_ 1
+
+#include <stdint.h>
+#include "util.h"
+#include "lock_free_dlist.h"
+
+/* ****************************************************************************
+ * Parallel traversal: lf_dlist_parallel_for() calls [fn] on the nodes of
+ * the list from [nthreads] threads: the calling one and nthreads - 1
+ * threads it creates for the call and joins before returning. That is a
+ * thread start and join per call, so it is meant for sweeps over many
+ * nodes, not for short lists.
+ *
+ * The list must be ordered and have a skip list index
+ * (lf_dlist_index_create()). It is cut into LF_DLIST_PAR_GRAIN ranges per
+ * thread at split points, a sample of one of the index's upper levels
+ * (skip_index_sample()): only O(ranges) index entries are read, not the
+ * list. A list without an index has nothing to sample from, and finding
+ * split points would take a serial walk over all of it, so it is refused.
+ *
+ * Each thread gets a block of consecutive ranges and takes them from the
+ * front of its block. Once its block is empty, it steals ranges from the
+ * back of the others'. A thread held up by a slow [fn] or a long range
+ * therefore does not hold up the rest.
+ *
+ * The traversal is as safe as a cursor against concurrent inserts and
+ * deletes: a range is walked with lf_dlist_get_next() inside the epoch,
+ * and the calling thread holds the epoch for the whole call, so that the
+ * split points stay readable; reclamation waits until the call returns,
+ * as with a cursor that has no hazard slot. [fn] may delete the node it is
+ * given and retire it. Nodes that are in the list for the whole call are
+ * visited; a node inserted or deleted meanwhile may or may not be. If a
+ * split point is deleted meanwhile, the range in front of it runs on to
+ * the next split point still linked, so some nodes may be visited twice,
+ * as after a cursor resumed from the head. A node found deleted when its
+ * turn comes is stepped over, never handed to [fn].
+ *
+ * Returns the number of [fn] calls, -1 on invalid arguments or a list
+ * without an index. */
+
+#define LF_DLIST_PAR_THREAD_MAX  64
+#define LF_DLIST_PAR_GRAIN       8   /* ranges per thread */
+
+typedef void (*lf_dlist_visit_fn_t)( dlist_node_t * node, void * ctx );
+
+int64_t lf_dlist_parallel_for( lf_dlist_t        * volatile l,
+                               uint32_t                     nthreads,
+                               lf_dlist_visit_fn_t          fn,
+                               void                       * ctx );
+
+#endif /* _PARALLEL_DLIST_H_ */
@@ -0,0 +1,179 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "atomic.h"
+#include "relaxed_dlist.h"
+#include "util.h"
+
+static const char * g_lf_dlist_lane_policy_name[LF_DLIST_LANE_POLICY_MAX] =
+{
+  "thread",
+  "round-robin"
+};
+
+int32_t lf_dlist_relaxed_create( lf_dlist_relaxed_t    ** _r,
+                                 uint32_t                 lane_cnt,
+                                 lf_dlist_lane_policy_t   policy,
+                                 backoff_policy_t         backoff_policy,
+                                 int32_t                  backoff_cnt_max )
+{
+  lf_dlist_relaxed_t * r = NULL;
+
+  TRY( _r == NULL );
+  TRY( lane_cnt == 0 || lane_cnt > LF_DLIST_RELAXED_LANE_MAX );
+  TRY( (int32_t)policy < 0 || policy >= LF_DLIST_LANE_POLICY_MAX );
+
+  TRY( posix_memalign( (void **)&r, 64, sizeof(lf_dlist_relaxed_t) ) != 0 );
+  memset( (void *)r, 0x00, sizeof(lf_dlist_relaxed_t) );
+
+  /* a lane per cache line or more: no false sharing between the tails */
+  TRY_GOTO( lf_dlist_lanes_create( &(r->lanes),
+                                   lane_cnt,
+                                   backoff_policy,
+                                   backoff_cnt_max ) != RC_SUCCESS,
+            err_alloc_lanes );
+
+  r->lane_cnt = lane_cnt;
+  r->policy   = policy;
+
+  *_r = r;
+
+  return RC_SUCCESS;
+
+  CATCH( err_alloc_lanes )
+    {
+      free( r );
+    }
+  CATCH_END;
+
+  return RC_FAIL;
+}
+
+void lf_dlist_relaxed_destroy( lf_dlist_relaxed_t * r )
+{
+  if( r == NULL )
+    {
+      return;
+    }
+
+  lf_dlist_lanes_destroy( r->lanes, r->lane_cnt );
+  free( r );
+}
+
+const char * lf_dlist_lane_policy_name( lf_dlist_lane_policy_t policy )
+{
+  if( (int32_t)policy < 0 || policy >= LF_DLIST_LANE_POLICY_MAX )
+    {
+      return "unknown";
+    }
+
+  return g_lf_dlist_lane_policy_name[policy];
+}
+
+lf_dlist_lane_policy_t lf_dlist_lane_policy_parse( const char * name )
+{
+  int32_t i = 0;
+
+  for( i = 0 ; i < LF_DLIST_LANE_POLICY_MAX ; i++ )
+    {
+      if( strcmp( name, g_lf_dlist_lane_policy_name[i] ) == 0 )
+        {
+          return (lf_dlist_lane_policy_t)i;
+        }
+    }
+
+  return LF_DLIST_LANE_POLICY_MAX;
+}
+
+lf_dlist_t * lf_dlist_relaxed_lane( lf_dlist_relaxed_t * r, uint32_t idx )
+{
+  return ( idx < r->lane_cnt ) ? r->lanes[idx].list : NULL;
+}
+
+lf_dlist_t * lf_dlist_relaxed_tail( lf_dlist_relaxed_t * r )
+{
+  uint64_t idx = 0;
+
+  if( r->lane_cnt == 1 )
+    {
+      return r->lanes[0].list;
+    }
+
+  if( r->policy == LF_DLIST_LANE_ROUND_ROBIN )
+    {
+      idx = atomic_fetch_inc( &(r->rr) );
+    }
+  else
+    {
+      /* a thread without a slot shares lane 0 */
+      idx = ( thread_slot_id() >= 0 ) ? (uint64_t)thread_slot_id() : 0;
+    }
+
+  return r->lanes[idx % r->lane_cnt].list;
+}
+
+DL_STATUS lf_dlist_relaxed_append( lf_dlist_relaxed_t * r, dlist_node_t * node )
+{
+  lf_dlist_t * l = lf_dlist_relaxed_tail( r );
+
+  return lf_dlist_insert_before( l, l->tail, node );
+}
+
+DL_STATUS lf_dlist_relaxed_append_chain( lf_dlist_relaxed_t * r,
+                                         dlist_node_t       * first,
+                                         dlist_node_t       * last )
+{
+  lf_dlist_t * l = lf_dlist_relaxed_tail( r );
+
+  return lf_dlist_insert_chain_before( l, l->tail, first, last );
+}
+
+lf_dlist_t * lf_dlist_relaxed_front( lf_dlist_relaxed_t * r )
+{
+  lf_dlist_t * l   = NULL;
+  uint32_t     i   = 0;
+  uint32_t     idx = 0;
+
+  for( i = 1 ; i <= r->lane_cnt ; i++ )
+    {
+      idx = (r->front + i) % r->lane_cnt;
+      l   = r->lanes[idx].list;
+      /* an append links the node behind head->next when the lane is */
+      /* empty; only the consumer unlinks it again */
+      if( lf_dlist_dereference_node_pointer_mem_only( atomic_load_acq( &(l->head->next) ) ) !=
+          l->tail )
+        {
+          r->front = idx;
+          return r->lanes[idx].list;
+        }
+    }
+
+  return NULL;
+}
+
+int64_t lf_dlist_relaxed_size( lf_dlist_relaxed_t * r )
+{
+  int64_t  sum = 0;
+  uint32_t i   = 0;
+
+  for( i = 0 ; i < r->lane_cnt ; i++ )
+    {
+      sum += lf_dlist_size( r->lanes[i].list );
+    }
+
+  return sum;
+}
+
+int64_t lf_dlist_relaxed_size_approx( lf_dlist_relaxed_t * r )
+{
+  int64_t  sum = 0;
+  uint32_t i   = 0;
+
+  for( i = 0 ; i < r->lane_cnt ; i++ )
+    {
+      sum += lf_dlist_size_approx( r->lanes[i].list );
+    }
+
+  return sum;
+}
@@ -0,0 +1,88 @@
+#ifndef _RELAXED_DLIST_H_
+#define _RELAXED_DLIST_H_ 1
+
+#include <stdint.h>
+#include "util.h"
+#include "backoff.h"
+#include "lock_free_dlist.h"
+
+/* ****************************************************************************
+ * Relaxed FIFO list: k lock-free lists (lanes), each with its own tail, for
+ * producers that only need an approximate arrival order. Appends to
+ * different lanes never touch the same tail, so they scale with the lanes
+ * instead of retrying on one CAS.
+ *
+ * A producer appends to the lane lf_dlist_relaxed_tail() picks for it:
+ *   thread       the lane of its thread slot (util.h): order is exact
+ *                among the nodes of one thread
+ *   round-robin  the next lane of a shared counter: a fetch-and-add, never
+ *                a retry; order is exact within a lane
+ * The consumer takes nodes at the front of the lane lf_dlist_relaxed_front()
+ * gives it, which goes round the non-empty lanes. With round-robin appends
+ * and a consumer that takes at most B nodes from a lane per turn, a node
+ * comes out at most (k - 1) * B places away from where a single FIFO would
+ * have put it; that is the order window, k - 1 for one node per turn. A
+ * consumer that takes whole runs per turn widens it by as much: the ager
+ * of lf_dlist_test (B = AGING_TAKE_MAX, 4096) only bounds it by
+ * (k - 1) * 4096. With the thread policy a lane holds the nodes of the
+ * threads of its slots, and there is no bound across threads. With k = 1
+ * the list is a plain FIFO.
+ *
+ * Each lane is a plain lf_dlist_t: producers append to it with any insert,
+ * push_back or transfer operation at its tail, the consumer deletes or
+ * takes at its head. There is one consumer at a time. */
+
+#define LF_DLIST_RELAXED_LANE_MAX  64
+
+typedef enum _lf_dlist_lane_policy lf_dlist_lane_policy_t;
+enum _lf_dlist_lane_policy
+{
+  LF_DLIST_LANE_THREAD      = 0,
+  LF_DLIST_LANE_ROUND_ROBIN = 1,
+  LF_DLIST_LANE_POLICY_MAX
+};
+
+typedef struct _lf_dlist_relaxed lf_dlist_relaxed_t;
+struct _lf_dlist_relaxed
+{
+  uint32_t                  lane_cnt;
+  lf_dlist_lane_policy_t    policy;
+  lf_dlist_lane_t         * lanes;
+  /* round-robin: appends so far, on a line of its own */
+  uint64_t ATOMIC_VAR       rr;
+  char                      pad[64 - sizeof(uint64_t)];
+  /* consumer only: lane lf_dlist_relaxed_front() looks at first */
+  uint32_t                  front;
+};
+
+int32_t lf_dlist_relaxed_create( lf_dlist_relaxed_t    ** r,
+                                 uint32_t                 lane_cnt,
+                                 lf_dlist_lane_policy_t   policy,
+                                 backoff_policy_t         backoff_policy,
+                                 int32_t                  backoff_cnt_max );
+/* No concurrent users; the nodes are the caller's */
+void lf_dlist_relaxed_destroy( lf_dlist_relaxed_t * r );
+
+const char * lf_dlist_lane_policy_name( lf_dlist_lane_policy_t policy );
+lf_dlist_lane_policy_t lf_dlist_lane_policy_parse( const char * name );
+
+lf_dlist_t * lf_dlist_relaxed_lane( lf_dlist_relaxed_t * r, uint32_t idx );
+
+/* Lane the calling producer appends to */
+lf_dlist_t * lf_dlist_relaxed_tail( lf_dlist_relaxed_t * r );
+DL_STATUS lf_dlist_relaxed_append( lf_dlist_relaxed_t * r, dlist_node_t * node );
+DL_STATUS lf_dlist_relaxed_append_chain( lf_dlist_relaxed_t * r,
+                                         dlist_node_t       * first,
+                                         dlist_node_t       * last );
+
+/* Consumer: the next lane with nodes in it, going round from the one after
+ * the lane returned last; NULL only if every lane was empty when it was
+ * looked at. A lane is empty when its head links to its tail, not by
+ * lf_dlist_size_approx(), which may lag behind an append. */
+lf_dlist_t * lf_dlist_relaxed_front( lf_dlist_relaxed_t * r );
+
+/* Sum over the lanes, see lf_dlist_size()/lf_dlist_size_approx() */
+int64_t lf_dlist_relaxed_size( lf_dlist_relaxed_t * r );
+int64_t lf_dlist_relaxed_size_approx( lf_dlist_relaxed_t * r );
+
+#endif /* _RELAXED_DLIST_H_ */
@@ -0,0 +1,364 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "atomic.h"
+#include "epoch.h"
+#include "skip_index.h"
+#include "util.h"
+
+#define SKIP_INDEX_MARK  ((uint64_t)0x1)
+
+#define skip_index_ptr( _link ) \
+  ((skip_entry_t *)((uint64_t)(_link) & ~SKIP_INDEX_MARK))
+#define skip_index_marked( _link ) \
+  ((((uint64_t)(_link)) & SKIP_INDEX_MARK) ? true : false)
+
+typedef struct _skip_entry skip_entry_t;
+struct _skip_entry
+{
+  int64_t                    key;
+  void                     * node;
+  uint32_t                   level;  /* height of the tower, 1 .. LEVEL_MAX */
+  /* the adding and the removing thread hold a reference each: the entry */
+  /* may still get linked at some level after it is removed, so the last */
+  /* one to let go unlinks it for good and retires it */
+  int32_t ATOMIC_VAR         refs;
+  skip_entry_t * ATOMIC_VAR  next[];
+};
+
+struct _skip_index
+{
+  skip_entry_t  * head;  /* LEVEL_MAX levels, below every key */
+};
+
+static bool skip_index_less( skip_entry_t * e, int64_t key, void * node )
+{
+  if( e->key != key )
+    {
+      return ( e->key < key ) ? true : false;
+    }
+
+  return ( (uint64_t)e->node < (uint64_t)node ) ? true : false;
+}
+
+/* Fill [preds]/[succs] with the last entry below ([key], [node]) and the
+ * first one not below it on every level, unlinking the removed entries met
+ * on the way. Returns true if succs[0] is the entry of ([key], [node]). */
+static bool skip_index_find( skip_index_t  * idx,
+                             int64_t         key,
+                             void          * node,
+                             skip_entry_t ** preds,
+                             skip_entry_t ** succs )
+{
+  skip_entry_t * pred = NULL;
+  skip_entry_t * curr = NULL;
+  skip_entry_t * succ = NULL;
+  int32_t        lvl  = 0;
+
+label_retry:
+  pred = idx->head;
+
+  for( lvl = SKIP_INDEX_LEVEL_MAX - 1 ; lvl >= 0 ; lvl-- )
+    {
+      curr = skip_index_ptr( atomic_load_acq( &(pred->next[lvl]) ) );
+
+      while( curr != NULL )
+        {
+          succ = atomic_load_acq( &(curr->next[lvl]) );
+          if( skip_index_marked( succ ) )
+            {
+              /* [curr] is removed: unlink it from this level; if [pred] */
+              /* got removed or changed meanwhile, start over */
+              if( atomic_cas_ptr( &(pred->next[lvl]), curr, skip_index_ptr( succ ) ) == false )
+                {
+                  goto label_retry;
+                }
+              curr = skip_index_ptr( succ );
+              continue;
+            }
+
+          if( skip_index_less( curr, key, node ) == false )
+            {
+              break;
+            }
+
+          pred = curr;
+          curr = skip_index_ptr( succ );
+        }
+
+      preds[lvl] = pred;
+      succs[lvl] = curr;
+    }
+
+  return ( succs[0] != NULL && succs[0]->key == key && succs[0]->node == node ) ? true : false;
+}
+
+static void skip_index_release( skip_index_t * idx, skip_entry_t * e )
+{
+  skip_entry_t * preds[SKIP_INDEX_LEVEL_MAX];
+  skip_entry_t * succs[SKIP_INDEX_LEVEL_MAX];
+
+  if( atomic_add_fetch( &(e->refs), -1 ) == 0 )
+    {
+      /* every level is marked by now and nobody links [e] anymore: */
+      /* after this search it cannot be reached from the head */
+      (void)skip_index_find( idx, e->key, e->node, preds, succs );
+      (void)epoch_retire( (void *)e, free );
+    }
+}
+
+static skip_entry_t * skip_index_alloc( uint32_t level )
+{
+  skip_entry_t * e = NULL;
+
+  e = (skip_entry_t *)calloc( 1, sizeof(skip_entry_t) + level * sizeof(skip_entry_t *) );
+  if( e != NULL )
+    {
+      e->level = level;
+    }
+
+  return e;
+}
+
+int32_t skip_index_create( skip_index_t ** _idx )
+{
+  skip_index_t * idx = NULL;
+
+  TRY( _idx == NULL );
+
+  idx = (skip_index_t *)calloc( 1, sizeof(skip_index_t) );
+  TRY( idx == NULL );
+
+  idx->head = skip_index_alloc( SKIP_INDEX_LEVEL_MAX );
+  TRY( idx->head == NULL );
+  idx->head->key = INT64_MIN;
+
+  *_idx = idx;
+
+  return RC_SUCCESS;
+
+  CATCH_END;
+
+  free( idx );
+
+  return RC_FAIL;
+}
+
+void skip_index_destroy( skip_index_t * idx )
+{
+  skip_entry_t * e    = NULL;
+  skip_entry_t * next = NULL;
+
+  if( idx == NULL )
+    {
+      return;
+    }
+
+  for( e = idx->head ; e != NULL ; e = next )
+    {
+      next = skip_index_ptr( atomic_load_rlx( &(e->next[0]) ) );
+      free( e );
+    }
+
+  free( idx );
+}
+
+int32_t skip_index_add( skip_index_t * idx, int64_t key, void * node, uint64_t hash )
+{
+  skip_entry_t * preds[SKIP_INDEX_LEVEL_MAX];
+  skip_entry_t * succs[SKIP_INDEX_LEVEL_MAX];
+  skip_entry_t * e    = NULL;
+  skip_entry_t * succ = NULL;
+  uint32_t       level = 0;
+  uint32_t       i     = 0;
+
+  /* P(level > n) = 2^-n */
+  level = 1 + (uint32_t)__builtin_ctzll( hash | ((uint64_t)1 << (SKIP_INDEX_LEVEL_MAX - 1)) );
+
+  e = skip_index_alloc( level );
+  TRY( e == NULL );
+  e->key  = key;
+  e->node = node;
+  e->refs = 2;
+
+  /* 1. the bottom level decides: once linked there, the entry is in */
+  while( true )
+    {
+      if( skip_index_find( idx, key, node, preds, succs ) == true )
+        {
+          free( e );
+          return RC_SUCCESS;
+        }
+
+      for( i = 0 ; i < level ; i++ )
+        {
+          atomic_store_rlx( &(e->next[i]), succs[i] );
+        }
+
+      if( atomic_cas_ptr( &(preds[0]->next[0]), succs[0], e ) )
+        {
+          break;
+        }
+    }
+
+  /* 2. the upper levels only speed up searches: give up on a level as */
+  /* soon as the entry is removed */
+  for( i = 1 ; i < level ; i++ )
+    {
+      while( true )
+        {
+          succ = atomic_load_acq( &(e->next[i]) );
+          if( skip_index_marked( succ ) )
+            {
+              goto label_done;
+            }
+
+          if( succ != succs[i] &&
+              atomic_cas_ptr( &(e->next[i]), succ, succs[i] ) == false )
+            {
+              goto label_done;
+            }
+
+          if( atomic_cas_ptr( &(preds[i]->next[i]), succs[i], e ) )
+            {
+              break;
+            }
+
+          if( skip_index_find( idx, key, node, preds, succs ) == false ||
+              succs[0] != e )
+            {
+              goto label_done;
+            }
+        }
+    }
+
+label_done:
+  skip_index_release( idx, e );
+
+  return RC_SUCCESS;
+
+  CATCH_END;
+
+  return RC_FAIL;
+}
+
+void skip_index_remove( skip_index_t * idx, int64_t key, void * node )
+{
+  skip_entry_t * preds[SKIP_INDEX_LEVEL_MAX];
+  skip_entry_t * succs[SKIP_INDEX_LEVEL_MAX];
+  skip_entry_t * e    = NULL;
+  skip_entry_t * succ = NULL;
+  int32_t        i    = 0;
+
+  if( skip_index_find( idx, key, node, preds, succs ) == false )
+    {
+      return;
+    }
+  e = succs[0];
+
+  /* mark the tower top down; the mark of the bottom level removes it */
+  for( i = (int32_t)e->level - 1 ; i >= 1 ; i-- )
+    {
+      do
+        {
+          succ = atomic_load_acq( &(e->next[i]) );
+        } while( skip_index_marked( succ ) == false &&
+                 atomic_cas_ptr( &(e->next[i]),
+                                 succ,
+                                 (skip_entry_t *)((uint64_t)succ | SKIP_INDEX_MARK) ) == false );
+    }
+
+  while( true )
+    {
+      succ = atomic_load_acq( &(e->next[0]) );
+      if( skip_index_marked( succ ) )
+        {
+          /* removed by someone else */
+          return;
+        }
+
+      if( atomic_cas_ptr( &(e->next[0]),
+                          succ,
+                          (skip_entry_t *)((uint64_t)succ | SKIP_INDEX_MARK) ) )
+        {
+          break;
+        }
+    }
+
+  (void)skip_index_find( idx, key, node, preds, succs );
+  skip_index_release( idx, e );
+}
+
+void * skip_index_floor( skip_index_t * idx, int64_t key, int64_t * entry_key )
+{
+  skip_entry_t * preds[SKIP_INDEX_LEVEL_MAX];
+  skip_entry_t * succs[SKIP_INDEX_LEVEL_MAX];
+
+  /* (key, NULL) is below every entry of [key] */
+  (void)skip_index_find( idx, key, NULL, preds, succs );
+  if( preds[0] == idx->head )
+    {
+      return NULL;
+    }
+
+  *entry_key = preds[0]->key;
+  return preds[0]->node;
+}
+
+int32_t skip_index_sample( skip_index_t * idx, void ** nodes, int32_t max )
+{
+  skip_entry_t * curr  = NULL;
+  skip_entry_t * succ  = NULL;
+  int64_t        key   = INT64_MIN;
+  int32_t        lvl   = 0;
+  int32_t        cnt   = 0;
+  int32_t        pos   = 0;
+  int32_t        taken = 0;
+
+  if( max <= 0 )
+    {
+      return 0;
+    }
+
+  /* the highest level with [max] entries or more: about twice as many on
+   * average, as the level above it has fewer */
+  for( lvl = SKIP_INDEX_LEVEL_MAX - 1 ; lvl >= 0 ; lvl-- )
+    {
+      cnt = 0;
+      for( curr = skip_index_ptr( atomic_load_acq( &(idx->head->next[lvl]) ) ) ;
+           curr != NULL ;
+           curr = skip_index_ptr( atomic_load_acq( &(curr->next[lvl]) ) ) )
+        {
+          cnt++;
+        }
+
+      if( cnt >= max )
+        {
+          break;
+        }
+    }
+
+  if( lvl < 0 )
+    {
+      lvl = 0;
+    }
+
+  for( curr = skip_index_ptr( atomic_load_acq( &(idx->head->next[lvl]) ) ) ;
+       curr != NULL && taken < max ;
+       curr = skip_index_ptr( succ ), pos++ )
+    {
+      succ = atomic_load_acq( &(curr->next[lvl]) );
+      /* entry taken * cnt / max of the level is the next one to take */
+      if( (int64_t)pos * max < (int64_t)taken * cnt ||
+          skip_index_marked( succ ) || curr->key == key )
+        {
+          continue;
+        }
+
+      nodes[taken++] = curr->node;
+      key = curr->key;
+    }
+
+  return taken;
+}
@@ -0,0 +1,47 @@
+#ifndef _SKIP_INDEX_H_
+#define _SKIP_INDEX_H_ 1
+
+#include <stdint.h>
+#include "util.h"
+
+/* ****************************************************************************
+ * Lock-free skip list of (key, node) entries, used as a sparse index over an
+ * ordered list: a lookup asks for the last entry below a key and continues
+ * on the list from its node.
+ *
+ * Entries are ordered by key, then by node address, so duplicate keys are
+ * fine. Every level is a singly linked list whose links carry a removed mark
+ * in their lowest bit (Fraser, Herlihy & Shavit); searches unlink marked
+ * entries on their way. Removed entries are freed through epoch_retire(),
+ * so all calls must be made inside an epoch critical section (epoch.h) and
+ * an entry read there stays readable until the section ends.
+ *
+ * The index never reads the nodes: whether a node is still in the list is
+ * up to the caller. */
+
+#define SKIP_INDEX_LEVEL_MAX  16
+
+typedef struct _skip_index skip_index_t;
+
+int32_t skip_index_create( skip_index_t ** idx );
+/* Frees every entry: no concurrent users, retired entries already freed */
+void skip_index_destroy( skip_index_t * idx );
+
+/* Index [node] under [key]; [hash] are random bits choosing the height of
+ * its tower. Adding an entry that is already there does nothing. */
+int32_t skip_index_add( skip_index_t * idx, int64_t key, void * node, uint64_t hash );
+/* Remove the entry of ([key], [node]) if there is one */
+void skip_index_remove( skip_index_t * idx, int64_t key, void * node );
+
+/* Node of the last entry with a key below [key], NULL if there is none.
+ * The key of that entry goes to [*entry_key], so that the entry before it
+ * is found with another call. */
+void * skip_index_floor( skip_index_t * idx, int64_t key, int64_t * entry_key );
+
+/* Up to [max] nodes spread evenly over the index, in key order and with
+ * distinct keys, into [nodes]; returns their number. It walks the highest
+ * level that has [max] entries or more, about 2 * [max] entries, and the
+ * levels above it. Removed entries are passed over. */
+int32_t skip_index_sample( skip_index_t * idx, void ** nodes, int32_t max );
+
+#endif /* _SKIP_INDEX_H_ */
@@ -0,0 +1,244 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "atomic.h"
+#include "striped_dlist.h"
+#include "util.h"
+
+int32_t lf_dlist_striped_create( lf_dlist_striped_t ** _s,
+                                 uint32_t              shard_cnt,
+                                 int64_t               range,
+                                 lf_dlist_key_fn_t     key_fn,
+                                 backoff_policy_t      backoff_policy,
+                                 int32_t               backoff_cnt_max )
+{
+  lf_dlist_striped_t * s = NULL;
+  uint32_t             i = 0;
+
+  TRY( _s == NULL || key_fn == NULL || range < 0 );
+  TRY( shard_cnt == 0 || shard_cnt > LF_DLIST_STRIPE_MAX );
+
+  s = (lf_dlist_striped_t *)calloc( 1, sizeof(lf_dlist_striped_t) );
+  TRY( s == NULL );
+
+  /* a shard per cache line or more: no false sharing between the ends */
+  TRY_GOTO( lf_dlist_lanes_create( &(s->shards),
+                                   shard_cnt,
+                                   backoff_policy,
+                                   backoff_cnt_max ) != RC_SUCCESS,
+            err_alloc_shards );
+
+  s->shard_cnt = shard_cnt;
+  s->range     = range;
+  s->key_fn    = key_fn;
+
+  for( i = 0 ; i < shard_cnt ; i++ )
+    {
+      lf_dlist_set_key_fn( s->shards[i].list, key_fn );
+      if( range > 0 )
+        {
+          /* tickets of a shard: the keys of its blocks, counted from 0 */
+          TRY_GOTO( lf_dlist_seq_create( s->shards[i].list, 0 ) != RC_SUCCESS,
+                    err_create_seq );
+        }
+    }
+
+  *_s = s;
+
+  return RC_SUCCESS;
+
+  CATCH( err_create_seq )
+    {
+      lf_dlist_striped_destroy( s );
+    }
+  CATCH( err_alloc_shards )
+    {
+      free( s );
+    }
+  CATCH_END;
+
+  return RC_FAIL;
+}
+
+void lf_dlist_striped_destroy( lf_dlist_striped_t * s )
+{
+  if( s == NULL )
+    {
+      return;
+    }
+
+  lf_dlist_lanes_destroy( s->shards, s->shard_cnt );
+  free( s );
+}
+
+uint32_t lf_dlist_striped_shard_of( lf_dlist_striped_t * s, int64_t key )
+{
+  if( s->range > 0 )
+    {
+      return (uint32_t)((uint64_t)(key / s->range) % s->shard_cnt);
+    }
+
+  return (uint32_t)(splitmix64( (uint64_t)key ) % s->shard_cnt);
+}
+
+lf_dlist_t * lf_dlist_striped_shard( lf_dlist_striped_t * s, uint32_t idx )
+{
+  return ( idx < s->shard_cnt ) ? s->shards[idx].list : NULL;
+}
+
+DL_STATUS lf_dlist_striped_append( lf_dlist_striped_t * s, dlist_node_t * node )
+{
+  lf_dlist_t   * l     = NULL;
+  dlist_node_t * first = NULL;
+  dlist_node_t * last  = NULL;
+  int64_t        key   = s->key_fn( node );
+  uint64_t       ticket = 0;
+
+  l = s->shards[lf_dlist_striped_shard_of( s, key )].list;
+
+  if( s->range == 0 )
+    {
+      return lf_dlist_insert_before( l, l->tail, node );
+    }
+
+  if( key < 0 )
+    {
+      return DL_STATUS_INVALID_ARGUMENT;
+    }
+
+  /* position of [key] among the keys of its shard */
+  ticket = (uint64_t)(key / (s->range * s->shard_cnt)) * (uint64_t)s->range +
+           (uint64_t)(key % s->range);
+  lf_dlist_chain_append( &first, &last, node );
+
+  return lf_dlist_seq_append( l, ticket, 1, first, last );
+}
+
+int64_t lf_dlist_striped_size( lf_dlist_striped_t * s )
+{
+  int64_t  sum = 0;
+  uint32_t i   = 0;
+
+  for( i = 0 ; i < s->shard_cnt ; i++ )
+    {
+      sum += lf_dlist_size( s->shards[i].list );
+    }
+
+  return sum;
+}
+
+int64_t lf_dlist_striped_size_approx( lf_dlist_striped_t * s )
+{
+  int64_t  sum = 0;
+  uint32_t i   = 0;
+
+  for( i = 0 ; i < s->shard_cnt ; i++ )
+    {
+      sum += lf_dlist_size_approx( s->shards[i].list );
+    }
+
+  return sum;
+}
+
+/* ****************************************************************************
+ * lf_dlist_striped_cursor_t
+ */
+
+/* Move the cursor of shard [i] on and cache its node and key. A cursor
+ * whose node was deleted may resume from the head of the shard: the nodes
+ * up to the key returned last are passed again. */
+static void lf_dlist_striped_cursor_advance( lf_dlist_striped_cursor_t * mc, int32_t i )
+{
+  dlist_node_t * node = NULL;
+  bool           was_on = ( mc->front[i] != NULL ) ? true : false;
+  int64_t        key = 0;
+
+  while( true )
+    {
+      node = dlist_cursor_next( &(mc->shard[i]) );
+      if( node == NULL || dlist_cursor_is_eol( &(mc->shard[i]) ) == true )
+        {
+          mc->front[i] = NULL;
+          return;
+        }
+
+      key = mc->s->key_fn( node );
+      if( was_on == false || key > mc->front_key[i] )
+        {
+          break;
+        }
+    }
+
+  mc->front[i]     = node;
+  mc->front_key[i] = key;
+}
+
+int32_t lf_dlist_striped_cursor_open( lf_dlist_striped_cursor_t * mc,
+                                      lf_dlist_striped_t        * s )
+{
+  uint32_t i = 0;
+
+  TRY( mc == NULL || s == NULL );
+
+  mc->s    = s;
+  mc->last = -1;
+
+  for( i = 0 ; i < s->shard_cnt ; i++ )
+    {
+      mc->front[i] = NULL;
+      TRY_GOTO( dlist_cursor_open( &(mc->shard[i]),
+                                   s->shards[i].list,
+                                   DL_CURSOR_DIR_FORWARD ) != RC_SUCCESS,
+                err_open_shard );
+      lf_dlist_striped_cursor_advance( mc, (int32_t)i );
+    }
+
+  return RC_SUCCESS;
+
+  CATCH( err_open_shard )
+    {
+      while( i-- > 0 )
+        {
+          dlist_cursor_close( &(mc->shard[i]) );
+        }
+    }
+  CATCH_END;
+
+  return RC_FAIL;
+}
+
+void lf_dlist_striped_cursor_close( lf_dlist_striped_cursor_t * mc )
+{
+  uint32_t i = 0;
+
+  for( i = 0 ; i < mc->s->shard_cnt ; i++ )
+    {
+      dlist_cursor_close( &(mc->shard[i]) );
+    }
+}
+
+dlist_node_t * lf_dlist_striped_cursor_next( lf_dlist_striped_cursor_t * mc )
+{
+  int32_t min = -1;
+  int32_t i   = 0;
+
+  if( mc->last >= 0 )
+    {
+      lf_dlist_striped_cursor_advance( mc, mc->last );
+    }
+
+  /* a linear scan: the shards are few and the keys are in one array */
+  for( i = 0 ; i < (int32_t)mc->s->shard_cnt ; i++ )
+    {
+      if( mc->front[i] != NULL &&
+          ( min < 0 || mc->front_key[i] < mc->front_key[min] ) )
+        {
+          min = i;
+        }
+    }
+
+  mc->last = min;
+
+  return ( min >= 0 ) ? mc->front[min] : NULL;
+}
@@ -0,0 +1,87 @@
+#ifndef _STRIPED_DLIST_H_
+#define _STRIPED_DLIST_H_ 1
+
+#include <stdint.h>
+#include "util.h"
+#include "backoff.h"
+#include "lock_free_dlist.h"
+
+/* ****************************************************************************
+ * Striped list: the nodes of one logical list spread over N independent
+ * lock-free lists (shards), so that inserters and sweepers of different
+ * shards never meet on the same head or tail.
+ *
+ * A node goes to the shard of its key, chosen either
+ *   by range  keys [0, range) in shard 0, [range, 2 * range) in shard 1 and
+ *             so on, round robin over the shards (range 1: key % N); or
+ *   by hash   of the key (range 0).
+ *
+ * In the range mode the keys are the dense sequence 0, 1, 2, ... and
+ * lf_dlist_striped_append() links every shard in key order through its
+ * ordered append sequencer (lf_dlist_seq_append()): a key is linked once
+ * every smaller key of its shard is, with no waiting. In the hash mode a
+ * shard is in the order its nodes were appended in.
+ *
+ * Each shard is a plain lf_dlist_t (lf_dlist_striped_shard()): a per-shard
+ * cursor is a dlist_cursor_t on it, shard-local eviction an evictor_t
+ * (evict.h) on it, and nodes are deleted from the shard they are in.
+ * lf_dlist_striped_cursor_t merges the shards back into one ordered stream,
+ * provided each shard is sorted by key and the keys are unique. */
+
+#define LF_DLIST_STRIPE_MAX  64
+
+typedef struct _lf_dlist_striped lf_dlist_striped_t;
+struct _lf_dlist_striped
+{
+  uint32_t                   shard_cnt;
+  int64_t                    range;   /* keys per block, 0: by hash */
+  lf_dlist_key_fn_t          key_fn;
+  lf_dlist_lane_t          * shards;
+};
+
+int32_t lf_dlist_striped_create( lf_dlist_striped_t ** s,
+                                 uint32_t              shard_cnt,
+                                 int64_t               range,
+                                 lf_dlist_key_fn_t     key_fn,
+                                 backoff_policy_t      backoff_policy,
+                                 int32_t               backoff_cnt_max );
+/* No concurrent users; the nodes are the caller's */
+void lf_dlist_striped_destroy( lf_dlist_striped_t * s );
+
+uint32_t lf_dlist_striped_shard_of( lf_dlist_striped_t * s, int64_t key );
+lf_dlist_t * lf_dlist_striped_shard( lf_dlist_striped_t * s, uint32_t idx );
+
+/* Link [node] at the tail of the shard of its key */
+DL_STATUS lf_dlist_striped_append( lf_dlist_striped_t * s, dlist_node_t * node );
+
+/* Sum over the shards, see lf_dlist_size()/lf_dlist_size_approx() */
+int64_t lf_dlist_striped_size( lf_dlist_striped_t * s );
+int64_t lf_dlist_striped_size_approx( lf_dlist_striped_t * s );
+
+/* ****************************************************************************
+ * Merged cursor: one forward cursor per shard and a k-way merge of their
+ * current nodes, smallest key first. The node returned stays protected by
+ * its shard cursor until the next call. A shard whose cursor got to its
+ * tail is done: what is appended to it later is not returned, so the
+ * stream never goes back to a smaller key. The shard cursors take hazard
+ * slots while the thread has some, and hold the epoch otherwise (see
+ * dlist_cursor_t). */
+typedef struct _lf_dlist_striped_cursor lf_dlist_striped_cursor_t;
+struct _lf_dlist_striped_cursor
+{
+  lf_dlist_striped_t * s;
+  dlist_cursor_t       shard[LF_DLIST_STRIPE_MAX];
+  /* current node of each shard cursor, NULL once it is done */
+  dlist_node_t       * front[LF_DLIST_STRIPE_MAX];
+  int64_t              front_key[LF_DLIST_STRIPE_MAX];
+  /* shard of the node returned last: moved on by the next call */
+  int32_t              last;
+};
+
+int32_t lf_dlist_striped_cursor_open( lf_dlist_striped_cursor_t * mc,
+                                      lf_dlist_striped_t        * s );
+void lf_dlist_striped_cursor_close( lf_dlist_striped_cursor_t * mc );
+/* Next node in key order, NULL at the end */
+dlist_node_t * lf_dlist_striped_cursor_next( lf_dlist_striped_cursor_t * mc );
+
+#endif /* _STRIPED_DLIST_H_ */
@@ -47,6 +47,104 @@ int thread_sleep( uint64_t sec, uint64_t usec )
 #endif
 }
 
+/* ****************************************************************************
+ * thread slots */
+static volatile int32_t g_thread_slot_used[THREAD_SLOT_MAX];
+static volatile int32_t g_thread_slot_high_water = 0;
+static pthread_key_t    g_thread_slot_key;
+static pthread_once_t   g_thread_slot_once = PTHREAD_ONCE_INIT;
+static __thread int32_t t_thread_slot = -1;
+static thread_slot_exit_fn_t g_thread_slot_exit_fn[THREAD_SLOT_EXIT_FN_MAX];
+static volatile int32_t      g_thread_slot_exit_fn_cnt = 0;
+
+static void thread_slot_release( void * arg )
+{
+  int32_t slot = (int32_t)((intptr_t)arg - 1);
+  int32_t i = 0;
+
+  mem_barrier();
+  for( i = 0 ; i < g_thread_slot_exit_fn_cnt ; i++ )
+    {
+      g_thread_slot_exit_fn[i]( slot );
+    }
+
+  t_thread_slot = -1;
+  mem_barrier();
+  g_thread_slot_used[slot] = 0;
+}
+
+int32_t thread_slot_atexit( thread_slot_exit_fn_t fn )
+{
+  static pthread_mutex_t mtx = PTHREAD_MUTEX_INITIALIZER;
+  int32_t ret = RC_FAIL;
+
+  pthread_mutex_lock( &mtx );
+  if( g_thread_slot_exit_fn_cnt < THREAD_SLOT_EXIT_FN_MAX )
+    {
+      g_thread_slot_exit_fn[g_thread_slot_exit_fn_cnt] = fn;
+      /* publish [fn] before the count that makes it visible */
+      mem_barrier();
+      g_thread_slot_exit_fn_cnt++;
+      ret = RC_SUCCESS;
+    }
+  pthread_mutex_unlock( &mtx );
+
+  return ret;
+}
+
+static void thread_slot_key_init( void )
+{
+  (void)pthread_key_create( &g_thread_slot_key, thread_slot_release );
+}
+
+int32_t thread_slot_id( void )
+{
+  int32_t slot = t_thread_slot;
+  int32_t hw   = 0;
+
+  if( slot >= 0 )
+    {
+      return slot;
+    }
+
+  (void)pthread_once( &g_thread_slot_once, thread_slot_key_init );
+
+  for( slot = 0 ; slot < THREAD_SLOT_MAX ; slot++ )
+    {
+      if( g_thread_slot_used[slot] == 0 &&
+          atomic_cas_32( &(g_thread_slot_used[slot]), 0, 1 ) == 0 )
+        {
+          break;
+        }
+    }
+
+  if( slot == THREAD_SLOT_MAX )
+    {
+      return -1;
+    }
+
+  /* raise the high water mark up to our slot */
+  while( (hw = g_thread_slot_high_water) <= slot )
+    {
+      if( atomic_cas_32( &g_thread_slot_high_water, hw, slot + 1 ) == hw )
+        {
+          break;
+        }
+    }
+
+  /* the value must be non-NULL for the destructor to be called */
+  (void)pthread_setspecific( g_thread_slot_key, (void *)((intptr_t)slot + 1) );
+  t_thread_slot = slot;
+
+  return slot;
+}
+
+int32_t thread_slot_high_water( void )
+{
+  mem_barrier();
+  return g_thread_slot_high_water;
+}
+
 #ifdef __APPLE__
 #include <mach/mach.h>
 #include <mach/mach_time.h>
@@ -47,6 +47,31 @@ uint64_t rdtsc(void);
 
 int thread_sleep( uint64_t sec, uint64_t usec );
 
+/* Dense per-thread slot numbers for per-thread tables (epoch records, ...).
+ * A slot is taken on the first call of a thread and given back when the
+ * thread exits, so at most THREAD_SLOT_MAX threads may use them at once.
+ * thread_slot_id() returns -1 if all slots are taken. Slots in
+ * [0, thread_slot_high_water()) have been handed out at least once. */
+#define THREAD_SLOT_MAX  256
+int32_t thread_slot_id( void );
+int32_t thread_slot_high_water( void );
+
+/* [fn] is called by every exiting thread that holds a slot, before the slot
+ * is given back; modules use it to clean up their per-slot records. */
+#define THREAD_SLOT_EXIT_FN_MAX  8
+typedef void (*thread_slot_exit_fn_t)( int32_t slot );
+int32_t thread_slot_atexit( thread_slot_exit_fn_t fn );
+
+/* splitmix64 finalizer: a bijection on 64 bits whose every output bit
+ * depends on every input bit. Hash of keys (hash_index.c, striped_dlist.c)
+ * and of node addresses (lock_free_dlist.c). */
+static inline uint64_t splitmix64( uint64_t h )
+{
+  h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+  return h ^ (h >> 31);
+}
+
 #ifdef __APPLE__
 #include <sys/types.h>
 pid_t gettid( void );